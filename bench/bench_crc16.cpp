@@ -0,0 +1,85 @@
+// Compares the slicing-by-8 crc16_ccitt() with the bit-by-bit loop it replaced.
+//
+// Usage: bench-crc16 [iterations]
+
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint16_t crc16_ccitt_bitwise(const char *data, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t k = 0; k < size; k++) {
+        crc ^= static_cast<uint8_t>(data[k]) << 8;
+        for (int i = 0; i < 8; ++i) {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ 0x1021;
+            else
+                crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+template <typename F>
+static double run(const std::vector<char> &data, size_t size, int n, F crc)
+{
+    unsigned sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n; i++)
+    {
+        sink += crc(data.data() + (i & 63), size);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    // Keep the loop from being optimized away
+    if (sink == 0xFFFFFFFF)
+    {
+        std::puts("");
+    }
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::vector<char> data(64 + 4096);
+    for (char &c : data)
+    {
+        c = char(std::rand());
+    }
+
+    for (size_t k = 0; k < 64; k++)
+    {
+        if (crc16_ccitt_bitwise(data.data() + k, 4000) != crc16_ccitt(QByteArrayView(data.data() + k, 4000)))
+        {
+            std::printf("mismatch at offset %zu\n", k);
+            return 1;
+        }
+    }
+
+    std::printf("%8s %12s %12s %8s\n", "bytes", "bitwise MB/s", "table MB/s", "speedup");
+
+    // 93 is the binary frame, ~120 a typical text frame
+    for (size_t size : {8, 32, 93, 128, 200, 1024, 4096})
+    {
+        int iterations = int(n * 64 / size) + 1;
+        double bitwise = run(data, size, iterations, crc16_ccitt_bitwise);
+        double table = run(data, size, iterations, [](const char *d, size_t s) {
+            return crc16_ccitt(QByteArrayView(d, qsizetype(s)));
+        });
+        double mb = double(size) * iterations / 1e6;
+
+        std::printf("%8zu %12.1f %12.1f %7.1fx\n", size, mb / bitwise, mb / table, bitwise / table);
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Sustained write throughput of the flight recorder: one producer thread
+// records telemetry-sized datagrams as fast as the recorder takes them, the
+// recorder writes its segments on its own thread. Compare with the link rate,
+// e.g. 8 satellites at the 50 ms telemetry period.
+//
+// Usage: bench-flight-recorder [records] [directory]
+
+#include "flight_recorder.h"
+#include "sat_config.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    long long n = argc > 1 ? std::atoll(argv[1]) : 1000000;
+    QTemporaryDir tmp;
+    QString dir = argc > 2 ? QString(argv[2]) : tmp.path();
+
+    // A text frame is about 150 bytes
+    char datagram[150];
+    memset(datagram, 'x', sizeof(datagram));
+    datagram[0] = '$';
+
+    FlightRecorder *recorder = new FlightRecorder();
+    QThread thread;
+    recorder->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::finished, recorder, &QObject::deleteLater);
+    thread.start();
+
+    bool started = false;
+    QMetaObject::invokeMethod(recorder, [&]() { return recorder->start(dir); }, Qt::BlockingQueuedConnection, &started);
+    if (!started)
+    {
+        std::fprintf(stderr, "cannot record to %s\n", qPrintable(dir));
+        return 1;
+    }
+
+    long long retries = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long i = 0; i < n; i++)
+    {
+        // A full ring means the producer got ahead of the disk writer
+        while (!recorder->record(RECORD_RX, recorder_clock_ns(), udp_endpoint_v4(0x7f000001, 8080), datagram, sizeof(datagram)))
+        {
+            retries++;
+            QThread::yieldCurrentThread();
+        }
+    }
+
+    QMetaObject::invokeMethod(recorder, &FlightRecorder::stop, Qt::BlockingQueuedConnection);
+
+    auto end = std::chrono::steady_clock::now();
+    double s = std::chrono::duration<double>(end - start).count();
+    double link_rate = 8 * 1000.0 / THREAD_PERIOD_TELEM_MILLIS;
+
+    std::printf("%lld records %.1f MB in %.3f s: %.0f records/s, %.1f MB/s, %lld full-ring retries\n",
+                (long long)recorder->records(), recorder->bytes() / 1e6, s,
+                recorder->records() / s, recorder->bytes() / 1e6 / s, retries);
+    std::printf("link rate of 8 satellites: %.0f records/s, headroom %.0fx\n",
+                link_rate, recorder->records() / s / link_rate);
+
+    thread.quit();
+    thread.wait();
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+// QCPGraph's interleaved QCPGraphDataContainer against QCPGraphSoaDataContainer,
+// which keeps keys and values in separate arrays, and QCPGraphFloatDataContainer,
+// which keeps them in single precision, at 1e5 to 1e8 points: value range of
+// the whole series and of a key range (what rescaleAxes and the y autoscale do
+// per replot), findBegin/findEnd, adaptive sampling, and rescaleAxes() itself.
+// Checks that the double containers give the same ranges and points, and how
+// far the float container's line points are from them on screen.
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM is set.
+//
+// Usage: bench-graph-soa [max points]
+
+#include "qcustomplot_containers.h"
+
+#include <QApplication>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// getOptimizedLineData() and getSourceLineData() are protected
+class soa_graph : public QCPGraph
+{
+public:
+    using QCPGraph::QCPGraph;
+
+    void line_data(QVector<QCPGraphData> *out) const
+    {
+        if (mDataSource)
+        {
+            getSourceLineData(out, 0, mDataSource->size());
+        }
+        else
+        {
+            getOptimizedLineData(out, mDataContainer->constBegin(), mDataContainer->constEnd());
+        }
+    }
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Milliseconds per call of f, averaged over reps calls
+template <typename F>
+static double time_ms(int reps, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++)
+    {
+        f();
+    }
+    return seconds_since(start) / reps * 1e3;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    long long max_points = argc > 1 ? std::atoll(argv[1]) : 100000000;
+
+    QCustomPlot plot;
+    plot.resize(1800, 600);
+    soa_graph *aos = new soa_graph(plot.xAxis, plot.yAxis);
+    soa_graph *soa = new soa_graph(plot.xAxis, plot.yAxis);
+    soa_graph *f32 = new soa_graph(plot.xAxis, plot.yAxis);
+
+    bool identical = true;
+    double max_pixels = 0;
+
+    for (long long n = 100000; n <= max_points; n *= 10)
+    {
+        // Noisy telemetry at the 50 ms period, on the plots' time axis
+        QSharedPointer<QCPGraphSoaDataContainer> source(new QCPGraphSoaDataContainer);
+        QSharedPointer<QCPGraphFloatDataContainer> floats(new QCPGraphFloatDataContainer);
+        {
+            QVector<double> keys(n);
+            QVector<double> values(n);
+            std::mt19937_64 rng(1);
+            std::normal_distribution<double> noise(0, 1);
+
+            for (long long i = 0; i < n; i++)
+            {
+                keys[i] = i * 0.05;
+                values[i] = 100 + noise(rng);
+            }
+
+            aos->setData(keys, values, true);
+            source->set(keys, values, true);
+            soa->setDataSource(source);
+            floats->set(keys, values, true);
+            f32->setDataSource(floats);
+        }
+
+        const QSharedPointer<QCPGraphDataContainer> container = aos->data();
+        const double end = (n - 1) * 0.05;
+        const int reps = n >= 10000000 ? 3 : 20;
+        bool found;
+
+        std::printf("%lld points, %d / %d / %d bytes per point\n", n,
+                    int(sizeof(QCPGraphData)), int(2 * sizeof(double)), int(2 * sizeof(float)));
+
+        // Whole series, then the last tenth as a scrolling plot would show it
+        for (int r = 0; r < 2; r++)
+        {
+            const QCPRange keys = r == 0 ? QCPRange() : QCPRange(end * 0.9, end);
+            QCPRange aos_range, soa_range;
+
+            double aos_ms = time_ms(reps, [&]() { aos_range = container->valueRange(found, QCP::sdBoth, keys); });
+            double soa_ms = time_ms(reps, [&]() { soa_range = source->valueRange(found, QCP::sdBoth, keys); });
+            double f32_ms = time_ms(reps, [&]() { floats->valueRange(found, QCP::sdBoth, keys); });
+
+            identical = identical && aos_range == soa_range;
+            std::printf("  value range %-6s: aos %8.2f ms, soa %8.2f ms, f32 %8.2f ms\n",
+                        r == 0 ? "all" : "tenth", aos_ms, soa_ms, f32_ms);
+        }
+
+        // Binary searches at random keys
+        {
+            const int searches = 1000000;
+            long long aos_sum = 0, soa_sum = 0, f32_sum = 0;
+            std::uniform_real_distribution<double> key(0, end);
+
+            std::mt19937_64 rng(2);
+            double aos_ns = time_ms(searches, [&]()
+            {
+                double k = key(rng);
+                aos_sum += (container->findEnd(k) - container->findBegin(k)) + (container->findBegin(k) - container->constBegin());
+            }) * 1e6;
+
+            rng.seed(2);
+            double soa_ns = time_ms(searches, [&]()
+            {
+                double k = key(rng);
+                soa_sum += (source->findEnd(k) - source->findBegin(k)) + source->findBegin(k);
+            }) * 1e6;
+
+            rng.seed(2);
+            double f32_ns = time_ms(searches, [&]()
+            {
+                double k = key(rng);
+                f32_sum += (floats->findEnd(k) - floats->findBegin(k)) + floats->findBegin(k);
+            }) * 1e6;
+
+            identical = identical && aos_sum == soa_sum;
+            std::printf("  findBegin/End   : aos %8.0f ns, soa %8.0f ns, f32 %8.0f ns\n", aos_ns, soa_ns, f32_ns);
+        }
+
+        // Adaptive sampling with everything on screen
+        {
+            plot.xAxis->setRange(0, end);
+            plot.replot(); // lays out the axis rect
+
+            QVector<QCPGraphData> aos_out, soa_out, f32_out;
+
+            double aos_ms = time_ms(reps, [&]() { aos_out.clear(); aos->line_data(&aos_out); });
+            double soa_ms = time_ms(reps, [&]() { soa_out.clear(); soa->line_data(&soa_out); });
+            double f32_ms = time_ms(reps, [&]() { f32_out.clear(); f32->line_data(&f32_out); });
+
+            identical = identical && aos_out.size() == soa_out.size() &&
+                        std::memcmp(aos_out.constData(), soa_out.constData(), aos_out.size() * sizeof(QCPGraphData)) == 0;
+
+            // Point by point, as long as the sampling kept as many points
+            double pixels = aos_out.size() == f32_out.size() ? 0 : INFINITY;
+            for (int i = 0; i < aos_out.size() && i < f32_out.size(); i++)
+            {
+                pixels = std::max(pixels, std::abs(plot.xAxis->coordToPixel(aos_out[i].key) - plot.xAxis->coordToPixel(f32_out[i].key)));
+                pixels = std::max(pixels, std::abs(plot.yAxis->coordToPixel(aos_out[i].value) - plot.yAxis->coordToPixel(f32_out[i].value)));
+            }
+            max_pixels = std::max(max_pixels, pixels);
+
+            std::printf("  line data       : aos %8.2f ms, soa %8.2f ms, f32 %8.2f ms, f32 off by %.2g px\n",
+                        aos_ms, soa_ms, f32_ms, pixels);
+        }
+
+        // rescaleAxes() of one graph, key range and value range
+        {
+            double aos_ms = time_ms(reps, [&]() { aos->rescaleAxes(); });
+            const QCPRange aos_y = plot.yAxis->range();
+
+            double soa_ms = time_ms(reps, [&]() { soa->rescaleAxes(); });
+            identical = identical && aos_y == plot.yAxis->range();
+
+            double f32_ms = time_ms(reps, [&]() { f32->rescaleAxes(); });
+
+            std::printf("  rescaleAxes     : aos %8.2f ms, soa %8.2f ms, f32 %8.2f ms\n", aos_ms, soa_ms, f32_ms);
+        }
+
+        aos->data()->clear();
+        soa->setDataSource(QSharedPointer<QCPGraphDataSource>());
+        f32->setDataSource(QSharedPointer<QCPGraphDataSource>());
+    }
+
+    std::printf("output %s, f32 at most %.2g px off\n", identical ? "identical" : "DIFFERS", max_pixels);
+
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// Adaptive sampling of QCPGraph (getOptimizedLineData) at 1e5 to 1e7 points
+// per graph on a plot 1800 pixels wide, with each QCP::SimdLevel the CPU
+// supports and the loop QCustomPlot 2.1.1 shipped with. Checks that every
+// level gives the same points as that loop, byte for byte, on a normal and
+// a reversed key axis.
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM is set.
+//
+// Usage: bench-line-decimation [max points], e.g. 100000000 for 1e8
+
+#include "qcustomplot.h"
+
+#include <QApplication>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+
+// getOptimizedLineData() is protected
+class decimation_graph : public QCPGraph
+{
+public:
+    using QCPGraph::QCPGraph;
+
+    void line_data(QVector<QCPGraphData> *out) const
+    {
+        getOptimizedLineData(out, mDataContainer->constBegin(), mDataContainer->constEnd());
+    }
+
+    // getOptimizedLineData() as in QCustomPlot 2.1.1, the reference
+    void original_line_data(QVector<QCPGraphData> *lineData) const
+    {
+        const QCPGraphDataContainer::const_iterator begin = mDataContainer->constBegin();
+        const QCPGraphDataContainer::const_iterator end = mDataContainer->constEnd();
+        QCPAxis *keyAxis = mKeyAxis.data();
+
+        if (begin == end)
+        {
+            return;
+        }
+
+        int dataCount = int(end - begin);
+        int maxCount = (std::numeric_limits<int>::max)();
+        if (mAdaptiveSampling)
+        {
+            double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key) - keyAxis->coordToPixel((end - 1)->key));
+            if (2 * keyPixelSpan + 2 < static_cast<double>((std::numeric_limits<int>::max)()))
+                maxCount = int(2 * keyPixelSpan + 2);
+        }
+
+        if (!mAdaptiveSampling || dataCount < maxCount)
+        {
+            lineData->resize(dataCount);
+            std::copy(begin, end, lineData->begin());
+            return;
+        }
+
+        QCPGraphDataContainer::const_iterator it = begin;
+        double minValue = it->value;
+        double maxValue = it->value;
+        QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
+        int reversedFactor = keyAxis->pixelOrientation();
+        int reversedRound = reversedFactor == -1 ? 1 : 0;
+        double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key) + reversedRound));
+        double lastIntervalEndKey = currentIntervalStartKey;
+        double keyEpsilon = qAbs(currentIntervalStartKey - keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey) + 1.0 * reversedFactor));
+        bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic;
+        int intervalDataCount = 1;
+        ++it;
+        while (it != end)
+        {
+            if (it->key < currentIntervalStartKey + keyEpsilon)
+            {
+                if (it->value < minValue)
+                    minValue = it->value;
+                else if (it->value > maxValue)
+                    maxValue = it->value;
+                ++intervalDataCount;
+            }
+            else
+            {
+                if (intervalDataCount >= 2)
+                {
+                    if (lastIntervalEndKey < currentIntervalStartKey - keyEpsilon)
+                        lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.2, currentIntervalFirstPoint->value));
+                    lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.25, minValue));
+                    lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.75, maxValue));
+                    if (it->key > currentIntervalStartKey + keyEpsilon * 2)
+                        lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.8, (it - 1)->value));
+                }
+                else
+                    lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+                lastIntervalEndKey = (it - 1)->key;
+                minValue = it->value;
+                maxValue = it->value;
+                currentIntervalFirstPoint = it;
+                currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key) + reversedRound));
+                if (keyEpsilonVariable)
+                    keyEpsilon = qAbs(currentIntervalStartKey - keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey) + 1.0 * reversedFactor));
+                intervalDataCount = 1;
+            }
+            ++it;
+        }
+        if (intervalDataCount >= 2)
+        {
+            if (lastIntervalEndKey < currentIntervalStartKey - keyEpsilon)
+                lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.2, currentIntervalFirstPoint->value));
+            lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.25, minValue));
+            lineData->append(QCPGraphData(currentIntervalStartKey + keyEpsilon * 0.75, maxValue));
+        }
+        else
+            lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
+    }
+};
+
+static bool same_points(const QVector<QCPGraphData> &a, const QVector<QCPGraphData> &b)
+{
+    return a.size() == b.size() && std::memcmp(a.constData(), b.constData(), a.size() * sizeof(QCPGraphData)) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    long long max_points = argc > 1 ? std::atoll(argv[1]) : 10000000;
+    const char *names[] = {"scalar", "sse2", "avx"};
+    const QCP::SimdLevel best = QCP::simdLevel();
+
+    QCustomPlot plot;
+    plot.resize(1800, 600);
+    decimation_graph *graph = new decimation_graph(plot.xAxis, plot.yAxis);
+
+    bool identical = true;
+
+    for (long long n = 100000; n <= max_points; n *= 10)
+    {
+        // Noisy telemetry at the 50 ms period, all of it on screen, with a few
+        // NaN values that the kernels have to skip as the original loop does
+        QVector<QCPGraphData> data(n);
+        std::mt19937_64 rng(1);
+        std::normal_distribution<double> noise(0, 1);
+
+        for (long long i = 0; i < n; i++)
+        {
+            data[i] = QCPGraphData(i * 0.05, i % 99991 == 7 ? qQNaN() : 100 + noise(rng));
+        }
+
+        graph->data()->set(data, true);
+        data = QVector<QCPGraphData>();
+        plot.xAxis->setRange(0, n * 0.05);
+        plot.replot(); // lays out the axis rect
+
+        QVector<QCPGraphData> reference;
+        const int reps = n >= 10000000 ? 3 : 20;
+
+        auto original_start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++)
+        {
+            reference.clear();
+            graph->original_line_data(&reference);
+        }
+        double original_ms = std::chrono::duration<double>(std::chrono::steady_clock::now() - original_start).count() / reps * 1e3;
+
+        std::printf("%10lld points %-8s: %8.2f ms, %.2f ns/point, %lld line points\n",
+                    n, "original", original_ms, original_ms * 1e6 / n, (long long)reference.size());
+
+        for (int level = QCP::slScalar; level <= best; level++)
+        {
+            QCP::setSimdLevel(QCP::SimdLevel(level));
+            QVector<QCPGraphData> out;
+
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++)
+            {
+                out.clear();
+                graph->line_data(&out);
+            }
+            double ms = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / reps * 1e3;
+
+            const bool same = same_points(out, reference);
+            identical &= same;
+
+            std::printf("%10lld points %-8s: %8.2f ms, %.2f ns/point, %lld line points%s\n",
+                        n, names[level], ms, ms * 1e6 / n, (long long)out.size(), same ? "" : ", DIFFERS");
+        }
+
+        // The pixel rounding flips on a reversed axis, checked once per size
+        plot.xAxis->setRangeReversed(true);
+        plot.replot();
+
+        reference.clear();
+        graph->original_line_data(&reference);
+
+        for (int level = QCP::slScalar; level <= best; level++)
+        {
+            QCP::setSimdLevel(QCP::SimdLevel(level));
+            QVector<QCPGraphData> out;
+            graph->line_data(&out);
+
+            if (!same_points(out, reference))
+            {
+                std::printf("%10lld points %-8s: reversed axis DIFFERS\n", n, names[level]);
+                identical = false;
+            }
+        }
+
+        plot.xAxis->setRangeReversed(false);
+
+        QCP::setSimdLevel(best);
+    }
+
+    std::printf("output %s\n", identical ? "identical" : "DIFFERS");
+
+    return identical ? 0 : 1;
+}
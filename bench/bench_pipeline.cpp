@@ -0,0 +1,311 @@
+// End-to-end throughput and latency of the ground station's receive path:
+// N simulated satellites on 127.0.0.x send text frames over loopback into a
+// UdpLink on its I/O thread, the GUI thread drains it into the sessions and
+// the ReplotScheduler plots the first unit, as in MainWindow.
+//
+// For every source count and telemetry rate it reports
+//   store  : kernel receive timestamp -> frame in the session's store
+//   pixels : kernel receive timestamp -> first replot showing the frame
+//   dropped: frames sent but never stored, in the socket or the ring
+//   cpu    : CPU time of the GUI and the I/O thread per stored frame
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM is set.
+//
+// Usage: bench-pipeline [seconds per point] [max sources]
+
+#include "latency_histogram.h"
+#include "mainwindow.h"
+#include "qcustomplot.h"
+#include "replot_scheduler.h"
+#include "session_manager.h"
+#include "telemetry.h"
+#include "udp_link.h"
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QGridLayout>
+#include <QThread>
+#include <QTimer>
+#include <QWidget>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef struct
+{
+    uint64_t sent;
+    uint64_t stored;
+    uint64_t overflow;
+    uint64_t replots;
+    double gui_cpu_s;
+    double rx_cpu_s;
+    LatencyHistogram store_us;
+    LatencyHistogram pixels_us;
+} point_result_t;
+
+static double thread_cpu_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// One socket per satellite on its own loopback address, so the sessions tell
+// them apart. Sends at rate_hz per source, the sources evenly out of phase.
+static uint64_t send_frames(int sources, double rate_hz, double seconds, quint16 dst_port, const std::atomic<bool> &stop)
+{
+    struct sockaddr_in dst = {};
+    dst.sin_family = AF_INET;
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dst.sin_port = htons(dst_port);
+
+    QVector<int> fds;
+    QVector<QByteArray> frames;
+
+    for (int i = 0; i < sources; i++)
+    {
+        struct sockaddr_in src = {};
+        src.sin_family = AF_INET;
+        src.sin_addr.s_addr = htonl(INADDR_LOOPBACK + uint32_t(i));
+
+        int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        ::bind(fd, reinterpret_cast<struct sockaddr *>(&src), sizeof(src));
+        fds.append(fd);
+
+        telemetry_t t = {};
+        for (int k = 0; k < 4; k++)
+        {
+            t.d[k] = 100.0f + i + k;
+            t.c[k] = 1000.0f - 10 * k;
+            t.kf_d[k] = 99.5f + i + k;
+            t.kf_v[k] = -1.25f + 0.5f * k;
+        }
+        t.state = DOCK_STATE_CONTROL;
+        frames.append(format_telemetry(t));
+    }
+
+    const int64_t interval_ns = int64_t(1e9 / (rate_hz * sources));
+    const int64_t end = monotonic_ns() + int64_t(seconds * 1e9);
+    int64_t next = monotonic_ns();
+    uint64_t sent = 0;
+
+    for (int i = 0; !stop.load(std::memory_order_relaxed) && next < end; i = (i + 1) % sources)
+    {
+        struct timespec ts = {time_t(next / 1000000000), long(next % 1000000000)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+
+        if (::sendto(fds[i], frames[i].constData(), size_t(frames[i].size()), 0,
+                     reinterpret_cast<struct sockaddr *>(&dst), sizeof(dst)) > 0)
+        {
+            sent++;
+        }
+
+        next += interval_ns;
+    }
+
+    for (int fd : fds)
+    {
+        ::close(fd);
+    }
+
+    return sent;
+}
+
+static point_result_t run_point(int sources, double rate_hz, double seconds)
+{
+    point_result_t r = {};
+
+    // The plots of one unit, like the TOF and EM plots of the TELEMETRY tab
+    QWidget window;
+    QGridLayout *layout = new QGridLayout(&window);
+    QCustomPlot *plots[4];
+
+    ReplotScheduler scheduler(PLOT_PERIOD_MILLIS, PLOT_PERIOD_MAX_MILLIS);
+
+    for (int p = 0; p < 4; p++)
+    {
+        plots[p] = new QCustomPlot(&window);
+        layout->addWidget(plots[p], p / 2, p % 2);
+
+        for (int g = 0; g < 4; g++)
+        {
+            plots[p]->addGraph();
+            scheduler.add_source(plots[p], g, TELEM_CH_D0 + 4 * p + g);
+        }
+    }
+
+    window.resize(1600, 900);
+    window.show();
+
+    QThread rx_thread;
+    UdpLink *link = new UdpLink(RX_RING_CAPACITY);
+    link->moveToThread(&rx_thread);
+    QObject::connect(&rx_thread, &QThread::finished, link, &QObject::deleteLater);
+    rx_thread.start();
+
+    bool bound = false;
+    QMetaObject::invokeMethod(link, [&]() { return link->open(0); }, Qt::BlockingQueuedConnection, &bound);
+    if (!bound)
+    {
+        std::fprintf(stderr, "cannot bind the link\n");
+        std::exit(1);
+    }
+
+    const quint16 port = link->local_port();
+
+    SessionManager sessions(link, TELEMETRY_WINDOW);
+    const udp_endpoint_t plotted = udp_endpoint_v4(INADDR_LOOPBACK, 0);
+    int64_t first_rx_ns = -1;
+    std::deque<int64_t> unplotted; // Arrival of the plotted unit's frames not yet on screen
+
+    // As MainWindow::receiveMessage(), timing every frame
+    QObject::connect(link, &UdpLink::telemetryReady, &window, [&]() {
+        telemetry_rx_t batch[64];
+        size_t n;
+
+        while ((n = link->drain(batch, 64)) > 0)
+        {
+            sessions.deliver(batch, n, link->now_ns());
+
+            const int64_t stored_ns = link->now_ns();
+
+            for (size_t i = 0; i < n; i++)
+            {
+                r.store_us.record(uint64_t(qMax<int64_t>(0, stored_ns - batch[i].rx_ns)) / 1000);
+
+                if (udp_endpoint_same_address(batch[i].src, plotted))
+                {
+                    if (first_rx_ns < 0)
+                    {
+                        first_rx_ns = batch[i].rx_ns;
+                    }
+
+                    unplotted.push_back(batch[i].rx_ns);
+                }
+            }
+
+            r.stored += n;
+        }
+    });
+
+    QObject::connect(&sessions, &SessionManager::sessionAdded, &window, [&](SatelliteSession *session) {
+        if (session->address() == udp_endpoint_address(plotted))
+        {
+            scheduler.set_store(&session->telemetry());
+        }
+    });
+
+    // Keys are seconds since the unit's first frame, every frame up to the
+    // newest key is on screen now
+    QObject::connect(plots[0], &QCustomPlot::afterReplot, &window, [&]() {
+        r.replots++;
+
+        // Live graphs draw the store through the scheduler's span sources
+        QSharedPointer<QCPGraphDataSource> source = plots[0]->graph(0)->dataSource();
+        if (!source || source->size() == 0 || first_rx_ns < 0)
+        {
+            return;
+        }
+
+        const int64_t newest_ns = first_rx_ns + int64_t(source->keyAt(source->size() - 1) * 1e9 + 0.5);
+        const int64_t now = link->now_ns();
+
+        while (!unplotted.empty() && unplotted.front() <= newest_ns)
+        {
+            r.pixels_us.record(uint64_t(qMax<int64_t>(0, now - unplotted.front())) / 1000);
+            unplotted.pop_front();
+        }
+    });
+
+    scheduler.start();
+
+    double rx_cpu_start = 0;
+    QMetaObject::invokeMethod(link, [&]() { rx_cpu_start = thread_cpu_s(); }, Qt::BlockingQueuedConnection);
+    const double gui_cpu_start = thread_cpu_s();
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> sent{0};
+    std::thread sender([&]() { sent = send_frames(sources, rate_hz, seconds, port, stop); });
+
+    // Run the GUI until the sender is done, then let the pipeline drain
+    QEventLoop loop;
+    QTimer::singleShot(int(seconds * 1000) + 300, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    stop = true;
+    sender.join();
+
+    r.gui_cpu_s = thread_cpu_s() - gui_cpu_start;
+    QMetaObject::invokeMethod(link, [&]() { r.rx_cpu_s = thread_cpu_s() - rx_cpu_start; }, Qt::BlockingQueuedConnection);
+
+    r.sent = sent;
+    r.overflow = link->overflow();
+
+    scheduler.stop();
+    QMetaObject::invokeMethod(link, &UdpLink::close, Qt::BlockingQueuedConnection);
+    rx_thread.quit();
+    rx_thread.wait();
+
+    return r;
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    double seconds = argc > 1 ? std::atof(argv[1]) : 3.0;
+    int max_sources = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    std::printf("%7s %6s %9s %9s %21s %21s %9s %9s %8s\n", "sources", "Hz", "frames/s", "dropped",
+                "store p50/p99/max us", "pixels p50/p99/max us", "gui ns/f", "rx ns/f", "replot/s");
+
+    for (int sources : {1, 8, 32, 64})
+    {
+        if (sources > max_sources)
+        {
+            break;
+        }
+
+        for (double rate : {20.0, 100.0, 500.0, 1000.0})
+        {
+            point_result_t r = run_point(sources, rate, seconds);
+            const double per_frame = r.stored ? 1e9 / r.stored : 0;
+
+            std::printf("%7d %6.0f %9.0f %9llu %6llu/%6llu/%7llu %6llu/%6llu/%7llu %9.0f %9.0f %8.1f\n",
+                        sources, rate, r.stored / seconds,
+                        (unsigned long long)(r.sent > r.stored ? r.sent - r.stored : 0),
+                        (unsigned long long)r.store_us.percentile(0.5), (unsigned long long)r.store_us.percentile(0.99),
+                        (unsigned long long)r.store_us.max(),
+                        (unsigned long long)r.pixels_us.percentile(0.5), (unsigned long long)r.pixels_us.percentile(0.99),
+                        (unsigned long long)r.pixels_us.max(),
+                        r.gui_cpu_s * per_frame, r.rx_cpu_s * per_frame, r.replots / seconds);
+
+            if (r.overflow > 0)
+            {
+                std::printf("        %llu of the dropped frames overflowed the ring\n", (unsigned long long)r.overflow);
+            }
+        }
+    }
+
+    return 0;
+}
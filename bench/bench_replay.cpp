@@ -0,0 +1,126 @@
+// Replay throughput: records binary telemetry of 8 satellites, then times
+// opening the recording (index build), seeks, and replaying it as fast as
+// possible with and without the sessions as the sink, as a multiple of real
+// time.
+//
+// Usage: bench-replay [frames] [directory]
+
+#include "flight_recorder.h"
+#include "replay_engine.h"
+#include "sat_config.h"
+#include "session_manager.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    long long n = argc > 1 ? std::atoll(argv[1]) : 1000000;
+    QTemporaryDir tmp;
+    QString dir = argc > 2 ? QString(argv[2]) : tmp.path();
+
+    const int units = 8;
+    const int64_t period_ns = int64_t(THREAD_PERIOD_TELEM_MILLIS) * 1000000;
+
+    FlightRecorder *recorder = new FlightRecorder();
+    QThread thread;
+    recorder->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::finished, recorder, &QObject::deleteLater);
+    thread.start();
+
+    bool started = false;
+    QMetaObject::invokeMethod(recorder, [&]() { return recorder->start(dir); }, Qt::BlockingQueuedConnection, &started);
+    if (!started)
+    {
+        std::fprintf(stderr, "cannot record to %s\n", qPrintable(dir));
+        return 1;
+    }
+
+    telemetry_t t = {};
+    char frame[sizeof(telemetry_frame_t)];
+    const int64_t t0 = recorder_clock_ns();
+
+    for (long long i = 0; i < n; i++)
+    {
+        t.d[0] = float(i % 1000);
+        t.state = DOCK_STATE_CONTROL;
+        qsizetype size = encode_telemetry_frame(t, uint16_t(i / units), frame, sizeof(frame));
+
+        while (!recorder->record(RECORD_RX, t0 + i / units * period_ns, udp_endpoint_v4(0x0a000001 + quint32(i % units), 8081), frame, size_t(size)))
+        {
+            QThread::yieldCurrentThread();
+        }
+    }
+
+    QMetaObject::invokeMethod(recorder, &FlightRecorder::stop, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+
+    QStringList segments = QDir(dir).entryList({"*.rec"}, QDir::Files, QDir::Name);
+    if (segments.isEmpty())
+    {
+        std::fprintf(stderr, "no recording in %s\n", qPrintable(dir));
+        return 1;
+    }
+
+    ReplayEngine replay;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!replay.open(QDir(dir).filePath(segments.first())))
+    {
+        std::fprintf(stderr, "cannot open the recording\n");
+        return 1;
+    }
+    double open_s = seconds_since(start);
+
+    const double recorded_s = replay.duration_ns() * 1e-9;
+    std::printf("%llu records, %.0f s of telemetry in %lld segments, opened in %.3f s\n",
+                (unsigned long long)replay.recording().count(), recorded_s, (long long)segments.size(), open_s);
+
+    // Random positions, each an index lookup plus a short scan
+    const int seeks = 10000;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<int64_t> offset(0, replay.duration_ns());
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < seeks; i++)
+    {
+        replay.seek(offset(rng));
+    }
+    std::printf("seek: %.2f us\n", seconds_since(start) / seeks * 1e6);
+
+    // Decode only
+    replay.seek(0);
+    start = std::chrono::steady_clock::now();
+    uint64_t frames = replay.run();
+    double s = seconds_since(start);
+    std::printf("decode only: %llu frames in %.3f s, %.0f frames/s, %.0fx real time\n",
+                (unsigned long long)frames, s, frames / s, recorded_s / s);
+
+    // Through the sessions, as in the ground station
+    SessionManager sessions(nullptr, 250);
+    replay.set_sink([&](const telemetry_rx_t *batch, size_t count, int64_t now_ns) { sessions.deliver(batch, count, now_ns); });
+
+    replay.seek(0);
+    start = std::chrono::steady_clock::now();
+    frames = replay.run();
+    s = seconds_since(start);
+    std::printf("sessions:    %llu frames in %.3f s, %.0f frames/s, %.0fx real time\n",
+                (unsigned long long)frames, s, frames / s, recorded_s / s);
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+// What autoscaling costs per replot as the data grows. The live plots' span
+// sources over a TelemetryStore window, with the range the store tracks and
+// with a scan. Then value ranges of random key ranges of a long history in
+// QCPGraphSoaDataContainer, from its segment tree and from the generic
+// QCPGraphDataSource scan. Checks that both ways give the same ranges.
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM is set.
+//
+// Usage: bench-rescale [max points]
+
+#include "qcustomplot_containers.h"
+#include "telemetry_store.h"
+
+#include <QApplication>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    long long max_points = argc > 1 ? std::atoll(argv[1]) : 10000000;
+
+    bool identical = true;
+
+    std::printf("store window through a span source, 20 new samples per replot:\n");
+
+    // The store keeps every column twice, 1M samples take 270 MB
+    for (long long window = 1000; window <= qMin(max_points, 1000000LL); window *= 10)
+    {
+        TelemetryStore store{size_t(window)};
+        QCPGraphSpanDataSource source;
+
+        std::mt19937_64 rng(1);
+        std::normal_distribution<double> noise(0, 1);
+        const int chunk = 20;
+        double values[TELEM_CHANNELS];
+        long long t = 0;
+
+        // As SatelliteSession::receive(), with a dropout now and then
+        auto feed = [&]()
+        {
+            for (int i = 0; i < chunk; i++, t++)
+            {
+                for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+                {
+                    values[ch] = t % 5003 == 0 ? qQNaN() : 100 * std::sin(t * 1e-4) + noise(rng);
+                }
+                store.append(t * 0.05, values);
+            }
+        };
+
+        while (t < window)
+        {
+            feed();
+        }
+
+        const int replots = window >= 1000000 ? 50 : 1000;
+        double feed_s = 0, tracked_s = 0, scanned_s = 0;
+        bool found;
+
+        for (int r = 0; r < replots; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            feed();
+            feed_s += seconds_since(start);
+
+            // As ReplotScheduler::update_sources() for one channel
+            const sample_span_t keys = store.keys();
+            const sample_span_t column = store.channel(TELEM_CH_D0);
+            double lower, upper;
+
+            start = std::chrono::steady_clock::now();
+            source.setData(keys.data, column.data, int(keys.size));
+            if (store.channel_range(TELEM_CH_D0, lower, upper))
+            {
+                source.setValueRange(true, QCPRange(lower, upper));
+            }
+            else
+            {
+                source.setValueRange(false);
+            }
+            QCPRange tracked = source.valueRange(found);
+            tracked_s += seconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            source.setData(keys.data, column.data, int(keys.size));
+            QCPRange scanned = source.valueRange(found);
+            scanned_s += seconds_since(start);
+
+            identical = identical && tracked == scanned;
+        }
+
+        std::printf("%10lld points: append %7.2f us, tracked range %8.3f us, scan %10.1f us\n",
+                    window, feed_s / replots * 1e6, tracked_s / replots * 1e6, scanned_s / replots * 1e6);
+    }
+
+    std::printf("history, value range of a random tenth:\n");
+
+    for (long long n = 100000; n <= max_points; n *= 10)
+    {
+        QCPGraphSoaDataContainer history;
+        {
+            QVector<double> keys(n);
+            QVector<double> values(n);
+            std::mt19937_64 rng(1);
+            std::normal_distribution<double> noise(0, 1);
+
+            for (long long i = 0; i < n; i++)
+            {
+                keys[i] = i * 0.05;
+                values[i] = 100 * std::sin(i * 1e-4) + noise(rng);
+            }
+
+            history.set(keys, values, true);
+        }
+
+        const double end = (n - 1) * 0.05;
+        bool found;
+
+        // The first query builds the tree
+        auto start = std::chrono::steady_clock::now();
+        history.valueRange(found);
+        double build_ms = seconds_since(start) * 1e3;
+
+        const int queries = n >= 10000000 ? 20 : 200;
+        double tree_s = 0, scan_s = 0;
+        std::mt19937_64 rng(2);
+        std::uniform_real_distribution<double> from(0, end * 0.9);
+
+        for (int q = 0; q < queries; q++)
+        {
+            const double lower = from(rng);
+            const QCPRange keys(lower, lower + end * 0.1);
+
+            start = std::chrono::steady_clock::now();
+            QCPRange tree = history.valueRange(found, QCP::sdBoth, keys);
+            tree_s += seconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            QCPRange scan = history.QCPGraphDataSource::valueRange(found, QCP::sdBoth, keys);
+            scan_s += seconds_since(start);
+
+            identical = identical && tree == scan;
+        }
+
+        std::printf("%10lld points: tree built in %7.2f ms, range %8.3f us, scan %10.1f us\n",
+                    n, build_ms, tree_s / queries * 1e6, scan_s / queries * 1e6);
+    }
+
+    std::printf("ranges %s\n", identical ? "identical" : "DIFFER");
+
+    return identical ? 0 : 1;
+}
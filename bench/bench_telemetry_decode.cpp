@@ -0,0 +1,252 @@
+// Compares the text and binary telemetry decoders in frames/sec on one core
+// and counts the heap allocations made per decoded frame. The "qstring" row
+// is the original QString/QStringList parser the text decoder replaced.
+//
+// Allocations are counted at malloc level, where Qt's QString, QByteArray and
+// QList data comes from. That needs glibc; elsewhere only operator new is
+// counted, which misses Qt's containers.
+//
+// Usage: bench-telemetry-decode [frames]
+
+#include "telemetry.h"
+
+#include <QByteArray>
+#include <QDebug>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> allocations{0};
+
+#if defined(__GLIBC__)
+
+// Interposes the allocator, operator new ends up here as well
+extern "C"
+{
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+}
+
+static const char *allocation_level = "malloc";
+
+#else
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static const char *allocation_level = "operator new";
+
+#endif
+
+// The text parser before the single pass one, as received from the socket
+static bool parse_telemetry_qstring(const QString &rx, telemetry_t &t)
+{
+    if (!rx.startsWith('$') || !rx.endsWith('#')){
+        qDebug() << "Invalid frame format";
+        return false;
+    }
+
+    QString payload = rx.mid(1, rx.length() - 1);
+    const QStringList components = payload.split(',');
+
+    // Initialize all values to 0 first
+    for (int i = 0; i < 4; ++i) {
+        t.d[i] = 0.0f;
+        t.c[i] = 0.0f;
+        t.kf_d[i] = 0.0f;
+        t.kf_v[i] = 0.0f;
+    }
+    t.crc = 0;
+
+    // Iterate over each comma separated components
+    for (const QString &component : components)
+    {
+        // Split by colon to separate type and values
+        QStringList parts = component.split(':');
+        if (parts.size() != 2)
+        {
+            return false;
+        }
+
+        QString type = parts[0];
+        QStringList values = parts[1].split('x');
+
+        if (type == "d") // Distance
+        {
+            for (int i = 0; i < qMin(4, values.size()); ++i)
+            {
+                t.d[i] = values[i].toFloat();
+            }
+        }
+        else if (type == "c") // current
+        {
+            for (int i = 0; i < qMin(4, values.size()); ++i) {
+                t.c[i] = values[i].toFloat();
+            }
+        }
+        else if (type == "e") // KF distance
+        {
+            for (int i = 0; i < qMin(4, values.size()); ++i) {
+                t.kf_d[i] = values[i].toFloat();
+            }
+        }
+        else if (type == "f") // KF velocity
+        {
+            for (int i = 0; i < qMin(4, values.size()); ++i) {
+                t.kf_v[i] = values[i].toFloat();
+            }
+        }
+        else if (type == "g") // Docking state
+        {
+            if (!values.isEmpty()) {
+                t.state = (dock_state)values[0].toUInt();
+            }
+        }
+        else if (type == "h") // Thread periods
+        {
+            for (int i = 0; i < qMin(5, values.size()); ++i) {
+                t.dt[i] = values[i].toFloat();
+            }
+        }
+        else if (type == "r") // CRC
+        {
+            if (!values.isEmpty()) {
+                t.crc = values[0].toUInt();
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static telemetry_t make_telemetry(int i)
+{
+    telemetry_t t;
+
+    for (int k = 0; k < 4; k++)
+    {
+        t.d[k] = 100.0f + k + (i % 50) * 0.5f;
+        t.c[k] = 1000.0f - k * 10 + (i % 7);
+        t.kf_d[k] = 99.5f + k + (i % 50) * 0.5f;
+        t.kf_v[k] = -1.25f + (i % 13) * 0.1f;
+    }
+
+    for (int k = 0; k < 5; k++)
+    {
+        t.dt[k] = 6.0f + k * 10;
+    }
+
+    t.state = DOCK_STATE_CONTROL;
+    t.ack = 0;
+    t.crc = 0;
+
+    return t;
+}
+
+static QByteArray make_text_frame(const telemetry_t &t)
+{
+    return QString("$d:%1x%2x%3x%4,c:%5x%6x%7x%8,e:%9x%10x%11x%12,f:%13x%14x%15x%16,g:%17,h:%18x%19x%20x%21x%22,r:%23#")
+        .arg(t.d[0]).arg(t.d[1]).arg(t.d[2]).arg(t.d[3])
+        .arg(t.c[0]).arg(t.c[1]).arg(t.c[2]).arg(t.c[3])
+        .arg(t.kf_d[0]).arg(t.kf_d[1]).arg(t.kf_d[2]).arg(t.kf_d[3])
+        .arg(t.kf_v[0]).arg(t.kf_v[1]).arg(t.kf_v[2]).arg(t.kf_v[3])
+        .arg(int(t.state))
+        .arg(t.dt[0]).arg(t.dt[1]).arg(t.dt[2]).arg(t.dt[3]).arg(t.dt[4])
+        .arg(t.crc)
+        .toUtf8();
+}
+
+template <typename F>
+static void run(const char *name, const QVector<QByteArray> &frames, int n, F decode)
+{
+    telemetry_t t;
+    int ok = 0;
+
+    long long allocations_start = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n; i++)
+    {
+        ok += decode(frames[i % frames.size()], t);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    long long allocated = allocations.load() - allocations_start;
+    double s = std::chrono::duration<double>(end - start).count();
+
+    std::printf("%-8s %10d frames %8.3f s %12.0f frames/s %8.1f ns/frame %6.2f allocs/frame (%d ok)\n",
+                name, n, s, n / s, s * 1e9 / n, double(allocated) / n, ok);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    QVector<QByteArray> text, binary;
+
+    for (int i = 0; i < 64; i++)
+    {
+        telemetry_t t = make_telemetry(i);
+        char buffer[sizeof(telemetry_frame_t)];
+
+        text.append(make_text_frame(t));
+        binary.append(QByteArray(buffer, encode_telemetry_frame(t, i, buffer, sizeof(buffer))));
+    }
+
+    std::printf("text frame %lld bytes, binary frame %lld bytes, allocations counted at %s\n",
+                (long long)text[0].size(), (long long)binary[0].size(), allocation_level);
+
+    run("qstring", text, n, [](const QByteArray &rx, telemetry_t &t) { return parse_telemetry_qstring(QString::fromUtf8(rx), t); });
+    run("text", text, n, [](const QByteArray &rx, telemetry_t &t) { return decode_telemetry(rx, t); });
+    run("binary", binary, n, [](const QByteArray &rx, telemetry_t &t) { return decode_telemetry(rx, t); });
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Compression ratio and decode throughput of TelemetryHistory. Takes the
+// received frames of a flight recording, one history per unit, or else
+// synthesizes a docking approach: ToF in whole mm with noise, coil currents
+// around the PI set-point, Kalman estimates, quantized like the firmware's
+// text frames and timestamped at the telemetry period with jitter.
+//
+// Usage: bench-telemetry-history [recording segment | hours]
+
+#include "recording_reader.h"
+#include "sat_config.h"
+#include "telemetry.h"
+#include "telemetry_history.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+typedef struct
+{
+    int64_t t_ns;
+    telemetry_t t;
+} sample_t;
+
+static std::vector<sample_t> synthesize(double hours)
+{
+    const int64_t period_ns = int64_t(THREAD_PERIOD_TELEM_MILLIS) * 1000000;
+    const long long n = (long long)(hours * 3600e9 / period_ns);
+
+    std::mt19937_64 rng(1);
+    std::normal_distribution<double> tof_noise(0, 2);
+    std::normal_distribution<double> current_noise(0, 4);
+    std::normal_distribution<double> jitter(0, 150000);
+
+    std::vector<sample_t> samples;
+    samples.reserve(size_t(n));
+
+    double kf_d[4] = {};
+    int64_t t_ns = 0;
+
+    for (long long i = 0; i < n; i++)
+    {
+        // A 5 min approach from 300 mm to contact, repeated
+        double phase = std::fmod(i * period_ns * 1e-9, 300.0) / 300.0;
+        double d = 300 * (1 - phase) * (1 - phase);
+        double setpoint = phase < 0.9 ? 500 : 0;
+
+        telemetry_t t = {};
+        for (int k = 0; k < 4; k++)
+        {
+            t.d[k] = float(std::max(0.0, std::round(d + k + tof_noise(rng))));
+            t.c[k] = float(setpoint + (setpoint > 0 ? current_noise(rng) : 0));
+            kf_d[k] += 0.2 * (t.d[k] - kf_d[k]);
+            t.kf_d[k] = float(kf_d[k]);
+            t.kf_v[k] = float(-600 * (1 - phase) / 300 + 0.05 * tof_noise(rng));
+        }
+        t.state = DOCK_STATE_CONTROL;
+
+        // The values as the text frame carries them
+        parse_telemetry(format_telemetry(t), t);
+
+        samples.push_back({t_ns, t});
+        t_ns += period_ns + int64_t(jitter(rng));
+    }
+
+    return samples;
+}
+
+static bool load(const QString &path, QHash<udp_endpoint_t, std::vector<sample_t>> &units)
+{
+    RecordingReader reader;
+    if (!reader.open(path))
+    {
+        return false;
+    }
+
+    record_pos_t pos = reader.begin();
+    recorder_record_t header;
+    QByteArrayView data;
+    telemetry_t t;
+    QHash<udp_endpoint_t, int64_t> first_ns;
+
+    while (reader.next(pos, header, data))
+    {
+        if (header.direction == RECORD_RX && decode_telemetry(data, t))
+        {
+            // Time since the unit's first frame, as in SatelliteSession
+            const udp_endpoint_t unit = recorder_record_endpoint(header);
+            int64_t first = first_ns.value(unit, header.time_ns);
+            first_ns[unit] = first;
+
+            units[unit].push_back({header.time_ns - first, t});
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QHash<udp_endpoint_t, std::vector<sample_t>> units;
+    double hours = 8;
+
+    if (argc > 1 && QString(argv[1]).endsWith(".rec"))
+    {
+        if (!load(argv[1], units))
+        {
+            std::fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        hours = argc > 1 ? std::atof(argv[1]) : hours;
+        units[udp_endpoint_t{}] = synthesize(hours);
+    }
+
+    const char *groups[] = {"time", "tof d", "coil c", "kf_d", "kf_v"};
+    uint64_t samples = 0;
+    uint64_t raw = 0;
+    uint64_t compressed = 0;
+    uint64_t group_bits[5] = {};
+    double append_s = 0;
+    double decode_s = 0;
+    uint64_t decoded = 0;
+    std::vector<double> keys;
+    std::vector<double> values;
+
+    for (const std::vector<sample_t> &unit : units)
+    {
+        TelemetryHistory h;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const sample_t &s : unit)
+        {
+            h.append(s.t_ns, s.t);
+        }
+        append_s += seconds_since(start);
+
+        // Every channel of every chunk, as a plot panning over the session
+        start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < h.chunks(); c++)
+        {
+            for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+            {
+                h.decode(c, ch, keys, values);
+                decoded += keys.size();
+            }
+        }
+        decode_s += seconds_since(start);
+
+        samples += h.size();
+        raw += h.raw_bytes();
+        compressed += h.bytes();
+
+        group_bits[0] += h.column_bits(0);
+        for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+        {
+            group_bits[1 + ch / 4] += h.column_bits(ch + 1);
+        }
+    }
+
+    if (samples == 0)
+    {
+        std::fprintf(stderr, "no telemetry\n");
+        return 1;
+    }
+
+    std::printf("%lld units, %llu samples: %.1f MB as doubles, %.1f MB compressed, ratio %.2f\n",
+                (long long)units.size(), (unsigned long long)samples, raw / 1e6, compressed / 1e6, double(raw) / compressed);
+
+    for (int g = 0; g < 5; g++)
+    {
+        std::printf("  %-7s %5.1f bits/value\n", groups[g], group_bits[g] / double(samples) / (g == 0 ? 1 : 4));
+    }
+
+    std::printf("append: %.0f samples/s\n", samples / append_s);
+    std::printf("decode: %.0f samples/s (timestamp + value)\n", decoded / decode_s);
+    std::printf("one unit for 24 h at the telemetry period: %.1f MB\n",
+                compressed / double(samples) * 24 * 3600 * 1000 / THREAD_PERIOD_TELEM_MILLIS / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// What a plot that left the live window costs per redraw: the points it gets
+// for time ranges from 10 s to the whole session, from the min/max pyramid
+// or the compressed samples as ReplotScheduler picks them, and the time to
+// produce them. Compare with decoding every sample of the range, which is
+// what QCPGraph::getOptimizedLineData would otherwise walk.
+//
+// Usage: bench-telemetry-lod [samples] [pixels]
+
+#include "sat_config.h"
+#include "telemetry_history.h"
+#include "telemetry_lod.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    long long n = argc > 1 ? std::atoll(argv[1]) : 5000000;
+    int pixels = argc > 2 ? std::atoi(argv[2]) : 1800;
+
+    const int64_t period_ns = int64_t(THREAD_PERIOD_TELEM_MILLIS) * 1000000;
+    TelemetryHistory history;
+    TelemetryLod lod;
+    double values[TELEM_CHANNELS];
+
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < n; i++)
+    {
+        for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+        {
+            values[ch] = float(100 * std::sin(i * 1e-4 + ch) + (i * 7919 % 13));
+        }
+
+        history.append(i * period_ns, values);
+        lod.append(i * period_ns * 1e-9, values);
+    }
+    double append_s = seconds_since(start);
+
+    const double end = lod.last_key();
+    std::printf("%lld samples (%.1f h): append %.0f samples/s, history %.1f MB, pyramid %.1f MB\n",
+                n, end / 3600, n / append_s, history.bytes() / 1e6, lod.bytes() / 1e6);
+
+    std::vector<double> keys;
+    std::vector<double> vals;
+
+    for (double span = 10; ; span *= 10)
+    {
+        span = std::min(span, end);
+
+        // Pan across the session, one redraw per position
+        const int redraws = 50;
+        size_t points = 0;
+        int level = lod.level_for(0, span, pixels);
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < redraws; r++)
+        {
+            double from = (end - span) * r / redraws;
+
+            if (level < 0)
+            {
+                points += history.read(int64_t(from * 1e9), int64_t((from + span) * 1e9), 0, keys, vals);
+            }
+            else
+            {
+                points += lod.envelope(level, from, from + span, 0, keys, vals);
+            }
+        }
+        double lod_ms = seconds_since(start) / redraws * 1e3;
+
+        // Every sample of the range instead
+        start = std::chrono::steady_clock::now();
+        size_t raw = history.read(0, int64_t(span * 1e9), 0, keys, vals);
+        double raw_ms = seconds_since(start) * 1e3;
+
+        std::printf("%10.0f s: level %2d, %7zu points in %7.3f ms | all %9zu samples in %8.2f ms\n",
+                    span, level, points / redraws, lod_ms, raw, raw_ms);
+
+        if (span >= end)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
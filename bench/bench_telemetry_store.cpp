@@ -0,0 +1,127 @@
+// Compares TelemetryStore with the QVector append/removeFirst sliding window
+// it replaced, at window sizes from 250 to 1M samples.
+//
+// Usage: bench-telemetry-store [appends per window size]
+
+#include "telemetry_store.h"
+
+#include <QVector>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// The previous MainWindow layout: tms, d[4], c[4], kf_d[4], kf_v[4]
+struct qvector_window
+{
+    QVector<double> columns[TELEM_CHANNELS + 1];
+    size_t window;
+
+    void append(double key, const double *values)
+    {
+        columns[0].append(key);
+        for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+        {
+            columns[ch + 1].append(values[ch]);
+        }
+
+        if (size_t(columns[0].size()) > window)
+        {
+            for (QVector<double> &column : columns)
+            {
+                column.removeFirst();
+            }
+        }
+    }
+
+    // What the plot timer walks for one graph
+    double sum(int ch) const
+    {
+        double s = 0;
+        for (double v : columns[ch + 1])
+        {
+            s += v;
+        }
+        return s;
+    }
+};
+
+struct store_window
+{
+    TelemetryStore store;
+
+    explicit store_window(size_t window) : store(window) {}
+
+    void append(double key, const double *values) { store.append(key, values); }
+
+    double sum(int ch) const
+    {
+        sample_span_t span = store.channel(ch);
+        double s = 0;
+        for (size_t i = 0; i < span.size; i++)
+        {
+            s += span.data[i];
+        }
+        return s;
+    }
+};
+
+template <typename W>
+static void run(const char *name, W &w, size_t window, int n)
+{
+    double values[TELEM_CHANNELS];
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        values[ch] = ch;
+    }
+
+    // Fill the window first, only the steady state is timed
+    for (size_t i = 0; i < window; i++)
+    {
+        w.append(i * 0.05, values);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n; i++)
+    {
+        values[i % TELEM_CHANNELS] += 1.0;
+        w.append((window + i) * 0.05, values);
+    }
+
+    auto mid = std::chrono::steady_clock::now();
+
+    double sink = 0;
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        sink += w.sum(ch);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    double append_ns = std::chrono::duration<double, std::nano>(mid - start).count() / n;
+    double scan_ns = std::chrono::duration<double, std::nano>(end - mid).count() / (double(window) * TELEM_CHANNELS);
+
+    std::printf("%-8s window %8zu  append %9.1f ns/frame  scan %6.2f ns/sample  (%g)\n",
+                name, window, append_ns, scan_ns, sink);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    for (size_t window : {size_t(250), size_t(1000), size_t(10000), size_t(100000), size_t(1000000)})
+    {
+        {
+            qvector_window w;
+            w.window = window;
+            run("QVector", w, window, n);
+        }
+        {
+            store_window w(window);
+            run("store", w, window, n);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+// Compares receiving telemetry through QUdpSocket, as UdpLink does on other
+// platforms, with the recvmmsg() backend it uses on Linux. Every round each
+// simulated satellite sends one frame over loopback, like one telemetry
+// period, then the receiver drains and decodes the burst.
+//
+// Syscalls are the socket calls made: for QUdpSocket hasPendingDatagrams()
+// and readDatagram() are one recvmsg() each, for the backend each recvmmsg().
+// CPU time is the receiving thread's, decoding included.
+//
+// Usage: bench-udp-receive [rounds]
+
+#include "telemetry.h"
+#include "udp_mmsg.h"
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <QVector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef struct
+{
+    long long frames;
+    long long syscalls;
+    double cpu_s;
+} rx_result_t;
+
+static double thread_cpu_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static QByteArray make_text_frame(int i)
+{
+    QByteArray body = QString("d:%1x%2x%3x%4,c:%5x%6x%7x%8,e:%9x%10x%11x%12,f:%13x%14x%15x%16,g:4,h:6x10x50x100x15,a:0")
+                          .arg(100.0 + i % 50).arg(101.5).arg(102.25).arg(103.0)
+                          .arg(1000 - i % 7).arg(990).arg(980).arg(970)
+                          .arg(99.5 + i % 50).arg(100.5).arg(101.5).arg(102.5)
+                          .arg(-1.25 + (i % 13) * 0.1).arg(0.5).arg(0.25).arg(-0.75)
+                          .toUtf8();
+
+    return '$' + body + ",r:" + QByteArray::number(crc16_ccitt(body)) + '#';
+}
+
+// One socket per simulated satellite, sending from its own port
+class satellites
+{
+public:
+    satellites(int count, quint16 dst_port)
+    {
+        dst.sin_family = AF_INET;
+        dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        dst.sin_port = htons(dst_port);
+
+        for (int i = 0; i < count; i++)
+        {
+            fds.append(::socket(AF_INET, SOCK_DGRAM, 0));
+            frames.append(make_text_frame(i));
+        }
+    }
+
+    ~satellites()
+    {
+        for (int fd : fds)
+        {
+            ::close(fd);
+        }
+    }
+
+    void send_round()
+    {
+        for (int i = 0; i < fds.size(); i++)
+        {
+            ::sendto(fds[i], frames[i].constData(), size_t(frames[i].size()), 0,
+                     reinterpret_cast<struct sockaddr *>(&dst), sizeof(dst));
+        }
+    }
+
+private:
+    struct sockaddr_in dst = {};
+    QVector<int> fds;
+    QVector<QByteArray> frames;
+};
+
+static rx_result_t run_qudpsocket(int sats, int rounds)
+{
+    QUdpSocket socket;
+    socket.bind(QHostAddress::LocalHost, 0);
+
+    satellites sim(sats, socket.localPort());
+    QHostAddress sender;
+    char buffer[MAX_BUFFER_SIZE_TELEM];
+    rx_result_t r = {0, 0, 0};
+
+    for (int round = 0; round < rounds; round++)
+    {
+        sim.send_round();
+
+        double start = thread_cpu_s();
+
+        for (;;)
+        {
+            r.syscalls++;
+            if (!socket.hasPendingDatagrams())
+            {
+                break;
+            }
+
+            r.syscalls++;
+            qint64 size = socket.readDatagram(buffer, sizeof(buffer), &sender);
+            if (size < 0)
+            {
+                break;
+            }
+
+            QByteArrayView rx(buffer, size);
+            telemetry_t t;
+            r.frames += decode_telemetry(rx, t) && check_telemetry_crc(rx, t);
+        }
+
+        r.cpu_s += thread_cpu_s() - start;
+    }
+
+    return r;
+}
+
+static rx_result_t run_recvmmsg(int sats, int rounds)
+{
+    UdpMmsgSocket socket;
+    socket.open(0);
+
+    satellites sim(sats, socket.local_port());
+    rx_result_t r = {0, 0, 0};
+    uint64_t syscalls_start = socket.syscalls();
+
+    for (int round = 0; round < rounds; round++)
+    {
+        sim.send_round();
+
+        double start = thread_cpu_s();
+        int n;
+
+        while ((n = socket.receive()) > 0)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                QByteArrayView rx(socket.data(i), qsizetype(socket.size(i)));
+                telemetry_t t;
+                r.frames += decode_telemetry(rx, t) && check_telemetry_crc(rx, t);
+            }
+        }
+
+        r.cpu_s += thread_cpu_s() - start;
+    }
+
+    r.syscalls = (long long)(socket.syscalls() - syscalls_start);
+    socket.close();
+
+    return r;
+}
+
+static void report(const char *name, int sats, int rounds, const rx_result_t &r)
+{
+    long long sent = (long long)sats * rounds;
+
+    std::printf("%-11s %4d sats %9lld frames (%lld lost) %6.2f syscalls/frame %8.0f ns cpu/frame\n",
+                name, sats, r.frames, sent - r.frames,
+                r.frames ? double(r.syscalls) / r.frames : 0.0,
+                r.frames ? r.cpu_s * 1e9 / r.frames : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    for (int sats : {1, 8, 32, 64})
+    {
+        report("QUdpSocket", sats, rounds, run_qudpsocket(sats, rounds));
+        report("recvmmsg", sats, rounds, run_recvmmsg(sats, rounds));
+    }
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+// libFuzzer entry point for the telemetry decoders, seeded with corpus/telemetry.
+//
+// Usage: fuzz-telemetry corpus/telemetry
+
+#include "telemetry.h"
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    telemetry_t t;
+    const QByteArrayView rx(reinterpret_cast<const char *>(data), qsizetype(size));
+
+    if (decode_telemetry(rx, t))
+    {
+        check_telemetry_crc(rx, t);
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "flight_recorder.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+int64_t recorder_clock_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+FlightRecorder::FlightRecorder(size_t segment_bytes, size_t ring_capacity, QObject *parent)
+    : QObject(parent)
+    , ring(ring_capacity)
+    , segment_size(qMax(segment_bytes, sizeof(recorder_segment_t) + sizeof(recorder_record_t) + RECORDER_MAX_DATAGRAM))
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    stop();
+}
+
+bool FlightRecorder::record(enum recorder_direction direction, int64_t time_ns, const udp_endpoint_t &peer, const char *data, size_t size,
+                            uint8_t flags)
+{
+    // Empty datagrams carry nothing and would read as the end of the segment
+    if (size == 0 || !recording.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    entry_t entry;
+    entry.time_ns = time_ns;
+    entry.peer = peer;
+    entry.direction = uint8_t(direction);
+    entry.flags = flags | (size > RECORDER_MAX_DATAGRAM ? RECORD_FLAG_TRUNCATED : 0);
+    entry.length = uint16_t(qMin<size_t>(size, RECORDER_MAX_DATAGRAM));
+    memcpy(entry.data, data, entry.length);
+
+    if (!ring.push(entry))
+    {
+        drop_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Don't wait for the timer when records come in faster than it drains them
+    if (ring.size() >= ring.capacity() / 2 && !flush_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        QMetaObject::invokeMethod(this, &FlightRecorder::flush, Qt::QueuedConnection);
+    }
+
+    return true;
+}
+
+bool FlightRecorder::start(const QString &dir)
+{
+    stop();
+
+    if (!QDir().mkpath(dir))
+    {
+        qDebug() << "Failed to create recording directory" << dir;
+        return false;
+    }
+
+    base_path = QDir(dir).filePath("dock-gs-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    segment_index = 0;
+    retry_millis = 0;
+    retry_clock.invalidate();
+    failing.store(false, std::memory_order_relaxed);
+
+    if (!open_segment())
+    {
+        return false;
+    }
+
+    if (!timer)
+    {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &FlightRecorder::flush);
+    }
+
+    timer->start(RECORDER_FLUSH_MILLIS);
+    recording.store(true, std::memory_order_release);
+
+    qDebug() << "Recording to" << base_path + "-*.rec";
+    return true;
+}
+
+void FlightRecorder::stop()
+{
+    if (!recording.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    if (timer)
+    {
+        timer->stop();
+    }
+
+    flush();
+    close_segment();
+
+    retry_clock.invalidate();
+    failing.store(false, std::memory_order_relaxed);
+}
+
+void FlightRecorder::flush()
+{
+    entry_t batch[64];
+    size_t n;
+
+    flush_pending.store(false, std::memory_order_release);
+
+    while ((n = ring.pop_batch(batch, 64)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            write(batch[i]);
+        }
+    }
+
+#ifdef Q_OS_UNIX
+    // Start writing the new pages back, without waiting for the disk
+    if (map && used > synced)
+    {
+        static const size_t page = size_t(sysconf(_SC_PAGESIZE));
+        size_t from = synced / page * page;
+
+        msync(map + from, used - from, MS_ASYNC);
+        synced = used;
+    }
+#endif
+}
+
+bool FlightRecorder::open_segment()
+{
+    file.setFileName(base_path + QString("-%1.rec").arg(segment_index, 3, 10, QChar('0')));
+
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(qint64(segment_size)))
+    {
+        qDebug() << "Failed to create" << file.fileName() << file.errorString();
+        file.close();
+        return false;
+    }
+
+    // Zero filled, so an unclosed segment ends at the first zero length
+    map = file.map(0, qint64(segment_size));
+
+    if (!map)
+    {
+        qDebug() << "Failed to map" << file.fileName() << file.errorString();
+        file.close();
+        return false;
+    }
+
+    recorder_segment_t header = {};
+    memcpy(header.magic, RECORDER_MAGIC, sizeof(RECORDER_MAGIC));
+    header.version = RECORDER_VERSION;
+    header.header_size = sizeof(recorder_segment_t);
+    header.segment = segment_index;
+
+    memcpy(map, &header, sizeof(header));
+    used = sizeof(header);
+    synced = 0;
+
+    return true;
+}
+
+void FlightRecorder::close_segment()
+{
+    if (!map)
+    {
+        return;
+    }
+
+    file.unmap(map);
+    map = nullptr;
+
+    // Drop the unused preallocated tail
+    file.resize(qint64(used));
+    file.close();
+}
+
+void FlightRecorder::retry_segment()
+{
+    if (open_segment())
+    {
+        if (failing.exchange(false, std::memory_order_relaxed))
+        {
+            qDebug() << "Recording again to" << file.fileName();
+        }
+
+        retry_millis = 0;
+        retry_clock.invalidate();
+        return;
+    }
+
+    // Don't hammer a full disk with an open for every record
+    retry_millis = retry_millis == 0 ? RECORDER_RETRY_MILLIS : qMin<qint64>(retry_millis * 2, RECORDER_RETRY_MAX_MILLIS);
+    retry_clock.start();
+    failing.store(true, std::memory_order_relaxed);
+}
+
+void FlightRecorder::write(const entry_t &entry)
+{
+    const size_t size = sizeof(recorder_record_t) + entry.length;
+
+    if (map && used + size > segment_size)
+    {
+        close_segment();
+        segment_index++;
+        retry_segment();
+    }
+    else if (!map && retry_clock.isValid() && retry_clock.hasExpired(retry_millis))
+    {
+        retry_segment();
+    }
+
+    if (!map)
+    {
+        drop_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    recorder_record_t header;
+    header.length = entry.length;
+    header.time_ns = entry.time_ns;
+    memcpy(header.ip, entry.peer.ip, sizeof(header.ip));
+    header.port = entry.peer.port;
+    header.direction = entry.direction;
+    header.flags = entry.flags;
+
+    memcpy(map + used, &header, sizeof(header));
+    memcpy(map + used + sizeof(header), entry.data, entry.length);
+    used += size;
+
+    record_count.fetch_add(1, std::memory_order_relaxed);
+    byte_count.fetch_add(size, std::memory_order_relaxed);
+}
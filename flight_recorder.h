@@ -0,0 +1,161 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+
+#include <atomic>
+#include <cstdint>
+
+#include "sat_config.h"
+#include "spsc_ring.h"
+#include "udp_endpoint.h"
+
+// Recording segment file: recorder_segment_t, then records back to back, each
+// a recorder_record_t followed by its datagram. A zero length marks the end of
+// a segment that was not closed cleanly. Multi-byte fields are little-endian.
+#define RECORDER_MAGIC "DOCKREC"
+#define RECORDER_VERSION 1
+
+// Segment files are preallocated and memory-mapped at this size
+#define RECORDER_SEGMENT_BYTES (64 * 1024 * 1024)
+
+// Longest datagram kept, longer ones are cut and flagged
+#define RECORDER_MAX_DATAGRAM MAX_BUFFER_SIZE_TELEM
+
+// Time between flushes of the queued records to the segment
+#define RECORDER_FLUSH_MILLIS 100
+
+// Wait before opening a segment again that failed to open, doubled after
+// every further failure up to the maximum
+#define RECORDER_RETRY_MILLIS 100
+#define RECORDER_RETRY_MAX_MILLIS 5000
+
+enum recorder_direction
+{
+    RECORD_RX, // Received from a satellite
+    RECORD_TX  // Sent to a satellite
+};
+
+#define RECORD_FLAG_TRUNCATED 0x01
+
+#pragma pack(push, 1)
+typedef struct
+{
+    char magic[8];        // RECORDER_MAGIC, zero padded
+    uint32_t version;     // RECORDER_VERSION
+    uint32_t header_size; // sizeof(recorder_segment_t)
+    uint32_t segment;     // Index of the segment within the recording
+    uint32_t reserved;
+} recorder_segment_t;
+
+typedef struct
+{
+    uint32_t length;   // Datagram bytes following the header, 0 ends the segment
+    int64_t time_ns;   // Wall clock, ns since the Unix epoch
+    uint8_t ip[16];    // Sender (rx) or destination (tx), IPv4 as IPv4-mapped, see udp_endpoint_t
+    uint16_t port;
+    uint8_t direction; // recorder_direction
+    uint8_t flags;     // RECORD_FLAG_*
+} recorder_record_t;
+#pragma pack(pop)
+
+static_assert(sizeof(recorder_segment_t) == 24, "recorder_segment_t must be packed");
+static_assert(sizeof(recorder_record_t) == 32, "recorder_record_t must be packed");
+
+// Sender or destination of a record
+inline udp_endpoint_t recorder_record_endpoint(const recorder_record_t &r)
+{
+    udp_endpoint_t e;
+    memcpy(e.ip, r.ip, sizeof(e.ip));
+    e.port = r.port;
+
+    return e;
+}
+
+// Wall clock [ns] as used for the record timestamps
+int64_t recorder_clock_ns();
+
+// Appends every datagram handed to record() to memory-mapped segment files.
+// record() only copies into a lock-free ring and never blocks, the segments
+// are written on the recorder's own thread, in batches every
+// RECORDER_FLUSH_MILLIS or as soon as the ring is half full. Call the slots
+// through queued connections once moved to its thread.
+class FlightRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FlightRecorder(size_t segment_bytes = RECORDER_SEGMENT_BYTES, size_t ring_capacity = 4096, QObject *parent = nullptr);
+    ~FlightRecorder();
+
+    // Producer side, one thread only. Returns false if the record was dropped
+    // because the ring is full, or not recorded because the recorder is
+    // stopped or the datagram is empty. flags are RECORD_FLAG_*, i.e.
+    // RECORD_FLAG_TRUNCATED if the socket already cut the datagram off.
+    bool record(enum recorder_direction direction, int64_t time_ns, const udp_endpoint_t &peer, const char *data, size_t size,
+                uint8_t flags = 0);
+
+    uint64_t records() const { return record_count.load(std::memory_order_relaxed); }
+    uint64_t bytes() const { return byte_count.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return drop_count.load(std::memory_order_relaxed); }
+
+    bool is_recording() const { return recording.load(std::memory_order_acquire); }
+
+    // True while the next segment can't be opened, e.g. on a full disk. Records
+    // are dropped meanwhile and the open is retried with backoff.
+    bool is_failing() const { return failing.load(std::memory_order_relaxed); }
+
+public slots:
+    // Starts a new recording in dir, named after the current time
+    bool start(const QString &dir);
+
+    // Writes what is queued and closes the segment
+    void stop();
+
+    void flush();
+
+private:
+    typedef struct
+    {
+        int64_t time_ns;
+        udp_endpoint_t peer;
+        uint8_t direction;
+        uint8_t flags;
+        uint16_t length;
+        char data[RECORDER_MAX_DATAGRAM];
+    } entry_t;
+
+    bool open_segment();
+
+    void close_segment();
+
+    void retry_segment();
+
+    void write(const entry_t &entry);
+
+    SpscRing<entry_t> ring;
+    std::atomic<bool> recording{false};
+    std::atomic<bool> flush_pending{false};
+    std::atomic<bool> failing{false};
+    std::atomic<uint64_t> record_count{0};
+    std::atomic<uint64_t> byte_count{0};
+    std::atomic<uint64_t> drop_count{0};
+
+    // Recorder thread only
+    QTimer *timer = nullptr;
+    QString base_path;
+    uint32_t segment_index = 0;
+    size_t segment_size;
+    QFile file;
+    uchar *map = nullptr;
+    size_t used = 0;
+    size_t synced = 0;
+    QElapsedTimer retry_clock;
+    qint64 retry_millis = 0;
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,126 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+// Log-linear (HDR-style) histogram of non-negative integer samples, e.g. in
+// microseconds. Values below 32 are exact, larger ones land in one of 16
+// sub-buckets per power of two, so percentiles are within ~6% of the true
+// value. record() and remove() are O(1), percentile() walks the buckets.
+class LatencyHistogram
+{
+public:
+    void record(uint64_t value)
+    {
+        value = clamp(value);
+        counts[bucket_of(value)]++;
+        total++;
+
+        if (value > max_value)
+        {
+            max_value = value;
+        }
+    }
+
+    // Takes back a value recorded earlier, for sliding windows. max() keeps
+    // the largest value ever recorded.
+    void remove(uint64_t value)
+    {
+        uint32_t &n = counts[bucket_of(clamp(value))];
+
+        if (n > 0)
+        {
+            n--;
+            total--;
+        }
+    }
+
+    void reset()
+    {
+        counts.fill(0);
+        total = 0;
+        max_value = 0;
+    }
+
+    uint64_t count() const { return total; }
+
+    uint64_t max() const { return max_value; }
+
+    // Upper bound of the bucket holding the q-th quantile, q in [0, 1]
+    uint64_t percentile(double q) const
+    {
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = uint64_t(q * total + 0.5);
+        if (rank < 1)
+        {
+            rank = 1;
+        }
+
+        uint64_t seen = 0;
+
+        for (int i = 0; i < buckets; i++)
+        {
+            seen += counts[i];
+
+            if (seen >= rank)
+            {
+                uint64_t upper = bucket_lower(i + 1) - 1;
+                return upper < max_value ? upper : max_value;
+            }
+        }
+
+        return max_value;
+    }
+
+private:
+    static constexpr int sub_bits = 5;
+    static constexpr int value_bits = 40;
+    static constexpr uint64_t value_limit = (uint64_t(1) << value_bits) - 1;
+    static constexpr int half = 1 << (sub_bits - 1);
+    static constexpr int buckets = (value_bits - sub_bits + 2) * half;
+
+    static uint64_t clamp(uint64_t value)
+    {
+        return value < value_limit ? value : value_limit;
+    }
+
+    static int bucket_of(uint64_t value)
+    {
+        if (value < (uint64_t(1) << sub_bits))
+        {
+            return int(value);
+        }
+
+        int msb = 63;
+        while (!(value >> msb))
+        {
+            msb--;
+        }
+
+        // Keep the top sub_bits bits of the value
+        int shift = msb - (sub_bits - 1);
+        return shift * half + int(value >> shift);
+    }
+
+    static uint64_t bucket_lower(int index)
+    {
+        if (index < (1 << sub_bits))
+        {
+            return uint64_t(index);
+        }
+
+        int shift = index / half - 1;
+        return uint64_t(index - shift * half) << shift;
+    }
+
+    std::array<uint32_t, buckets> counts{};
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -4,6 +4,7 @@
 #include "ui_mainwindow.h"
 
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QString>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -13,137 +14,10 @@
 
 #include <QUdpSocket>           // For UDP socket functionality
 #include <QHostInfo>
+#include <QStandardPaths>
 
-uint16_t crc16_ccitt(const QByteArray &data)
+void MainWindow::update_telemetry_labels(const telemetry_t &t)
 {
-    uint16_t crc = 0xFFFF;
-    for (char byte : data) {
-        crc ^= static_cast<uint8_t>(byte) << 8;
-        for (int i = 0; i < 8; ++i) {
-            if (crc & 0x8000)
-                crc = (crc << 1) ^ 0x1021;
-            else
-                crc <<= 1;
-        }
-    }
-    return crc;
-}
-
-bool parse_telemetry(const QString &rx, telemetry_t &t)
-{
-    if (!rx.startsWith('$') || !rx.endsWith('#')){
-        qDebug() << "Invalid frame format";
-        return false;
-    }
-
-    QString payload = rx.mid(1, rx.length() - 1);
-    const QStringList components = payload.split(',');
-
-    // Initialize all values to 0 first
-    for (int i = 0; i < 4; ++i) {
-        t.d[i] = 0.0f;
-        t.c[i] = 0.0f;
-        t.kf_d[i] = 0.0f;
-        t.kf_v[i] = 0.0f;
-    }
-    t.crc = 0;
-
-    // Iterate over each comma separated components
-    for (const QString &component : components)
-    {
-        // Split by colon to separate type and values
-        QStringList parts = component.split(':');
-        if (parts.size() != 2)
-        {
-            // qDebug() << "Invalid component:" << component;
-            return false;
-        }
-
-        QString type = parts[0];
-        QStringList values = parts[1].split('x');
-
-        if (type == "d") // Distance
-        {
-            for (int i = 0; i < qMin(4, values.size()); ++i)  // Use qMin to prevent overflow
-            {
-                t.d[i] = values[i].toFloat();
-            }
-        }
-        else if (type == "c") // current
-        {
-            for (int i = 0; i < qMin(4, values.size()); ++i) {
-                t.c[i] = values[i].toFloat();
-            }
-        }
-        else if (type == "e") // KF distance
-        {
-            for (int i = 0; i < qMin(4, values.size()); ++i) {
-                t.kf_d[i] = values[i].toFloat();
-            }
-        }
-        else if (type == "f") // KF velocity
-        {
-            for (int i = 0; i < qMin(4, values.size()); ++i) {
-                t.kf_v[i] = values[i].toFloat();
-            }
-        }
-        else if (type == "g") // Docking state
-        {
-            if (!values.isEmpty()) {
-                t.state = (dock_state)values[0].toUInt();
-            }
-        }
-        else if (type == "h") // Thread periods
-        {
-            for (int i = 0; i < qMin(5, values.size()); ++i) {
-                t.dt[i] = values[i].toFloat();
-            }
-        }
-        else if (type == "r") // CRC
-        {
-            if (!values.isEmpty()) {
-                t.crc = values[0].toUInt();
-            }
-        }
-        else
-        {
-             // qDebug() << "Unknown data type:" << type;
-            return false;
-        }
-    }
-
-    return true;
-}
-
-static double count = 0;
-
-void MainWindow::populate_telemetry(const telemetry_t &t)
-{
-    tms.append(count);
-    count += 0.055;
-
-    for (uint8_t i = 0; i < 4; i++)
-    {
-        d[i].append(t.d[i]);
-        c[i].append(t.c[i]);
-        kf_d[i].append(t.kf_d[i]);
-        kf_v[i].append(t.kf_v[i]);
-    }
-
-
-    if (tms.size() > 250)
-    {
-        tms.removeFirst();
-
-        for (uint8_t i = 0; i < 4; i++)
-        {
-            d[i].removeFirst();
-            c[i].removeFirst();
-            kf_d[i].removeFirst();
-            kf_v[i].removeFirst();
-        }
-    }
-
     QLabel *state_labels[6] = {ui->label_status_idle,
                               ui->label_status_capture,
                               ui->label_status_control,
@@ -166,11 +40,28 @@ void MainWindow::populate_telemetry(const telemetry_t &t)
     ui->label_dock_info_em2->setText("em2 : " + QString::number(t.c[2]));
     ui->label_dock_info_em3->setText("em3 : " + QString::number(t.c[3]));
 
-    ui->label_dock_info_period_dock->setText("dock : " + QString::number(t.dt[0]) + " / " + QString::number(THREAD_PERIOD_DOCK_MILLIS));
-    ui->label_dock_info_period_coil->setText("coil : " + QString::number(t.dt[1]) + " / " + QString::number(THREAD_PERIOD_COIL_MILLIS));
-    ui->label_dock_info_period_tcmd->setText("telem : " + QString::number(t.dt[2]) + " / " + QString::number(THREAD_PERIOD_TELEM_MILLIS));
-    ui->label_dock_info_period_telem->setText("tcmd : " + QString::number(t.dt[3]) + " / " + QString::number(THREAD_PERIOD_TCMD_MILLIS));
-    ui->label_dock_info_period_telem_2->setText("range : " + QString::number(t.dt[4]) + " / " + QString::number(THREAD_PERIOD_RANGE_MILLIS));
+    // In the order of dt[]
+    QLabel *period_labels[FW_THREADS] = {ui->label_dock_info_period_dock, ui->label_dock_info_period_coil,
+                                         ui->label_dock_info_period_telem, ui->label_dock_info_period_tcmd,
+                                         ui->label_dock_info_period_telem_2};
+    uint32_t alarms = selected ? selected->thread_health().alarms() : 0;
+
+    for (int i = 0; i < FW_THREADS; i++)
+    {
+        period_labels[i]->setText(QString(fw_thread_name(fw_thread(i))) + " : " + QString::number(t.dt[i]) + " / " +
+                                  QString::number(fw_thread_period(fw_thread(i))));
+    }
+
+    // Red while a thread overran its deadline within the monitor's window
+    if (alarms != thread_alarms_shown)
+    {
+        for (int i = 0; i < FW_THREADS; i++)
+        {
+            period_labels[i]->setStyleSheet(alarms & (1u << i) ? "color: #ff5e5e;" : "");
+        }
+
+        thread_alarms_shown = alarms;
+    }
 
 
     for (int i = 0; i < 6; i++)
@@ -356,7 +247,12 @@ void estvel_init_plot(QCustomPlot *p)
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , udp_socket(new QUdpSocket(this))
+    , udp_link(new UdpLink(RX_RING_CAPACITY))
+    , recorder(new FlightRecorder())
+    , sessions(new SessionManager(udp_link, TELEMETRY_WINDOW, this))
+    , replay(new ReplayEngine(this))
+    , replay_sessions(new SessionManager(nullptr, TELEMETRY_WINDOW, this))
+    , shown(sessions)
 {
     ui->setupUi(this);
 
@@ -384,6 +280,7 @@ MainWindow::MainWindow(QWidget *parent)
     ui->textEdit_udp_ip->setText("tamariw.local");
     ui->textEdit_udp_port->setText("8080");
     ui->textEdit_udp_port_local->setText("8081");
+    ui->textEdit_tcmd_pacing->setText(QString::number(TCMD_PACING_MILLIS));
 
     ui->textEdit_kf_q00->setText(QString::number(KF1D_Q_POS));
     ui->textEdit_kf_q11->setText(QString::number(KF1D_Q_VEL));
@@ -419,119 +316,362 @@ MainWindow::MainWindow(QWidget *parent)
     ui->widget_plot_est3->plotLayout()->insertRow(0);
     ui->widget_plot_est3->plotLayout()->addElement(0, 0, new QCPTextElement(ui->widget_plot_est3, "TF3", QFont("Courier New", 14, QFont::Bold)));
 
-    timer_plot_mag = new QTimer(this);
+    plot_scheduler = new ReplotScheduler(PLOT_PERIOD_MILLIS, PLOT_PERIOD_MAX_MILLIS, this);
+
+    QCustomPlot *est[4] = {ui->widget_plot_est0, ui->widget_plot_est1, ui->widget_plot_est2, ui->widget_plot_est3};
+    QCustomPlot *estv[4] = {ui->widget_plot_estv0, ui->widget_plot_estv1, ui->widget_plot_estv2, ui->widget_plot_estv3};
 
-    connect(timer_plot_mag, &QTimer::timeout, this, [this]()
+    for (int i = 0; i < 4; ++i)
     {
-        for (int i = 0; i < 4; ++i)
+        plot_scheduler->add_source(ui->widget_em_plot, i, TELEM_CH_C0 + i);
+        plot_scheduler->add_source(ui->widget_tof_plot, i, TELEM_CH_D0 + i);
+        plot_scheduler->add_source(est[i], 0, TELEM_CH_D0 + i);
+        plot_scheduler->add_source(est[i], 1, TELEM_CH_KF_D0 + i);
+        plot_scheduler->add_source(estv[i], 0, TELEM_CH_KF_V0 + i);
+    }
+
+    plot_scheduler->start();
+
+    // Plots on the newly shown tab may be a few ticks behind
+    connect(ui->tabWidget, &QTabWidget::currentChanged, plot_scheduler, &ReplotScheduler::refresh);
+
+    timer_link_stats = new QTimer(this);
+
+    connect(timer_link_stats, &QTimer::timeout, this, [this]()
+    {
+        if (!selected)
+        {
+            return;
+        }
+
+        const link_stats_t &link = selected->link();
+
+        ui->label_link_frames->setText("frames  : " + QString::number(link.frames));
+        // Exact for binary frames, text frames have no counter and the drops
+        // are guessed from arrival gaps, which a stalled ground station inflates
+        ui->label_link_dropped->setText("dropped : " + QString::number(link.dropped) +
+                                        (link.last_seq >= 0 ? " (frame counter)" : " (arrival gaps, estimate)"));
+        // Text frames with a mismatching CRC are delivered, see telemetry_crc_enforced()
+        ui->label_link_corrupt->setText(QString("corrupt : %1, CRC mismatch %2")
+                                            .arg(udp_link->corrupt())
+                                            .arg(udp_link->crc_mismatches()));
+        ui->label_link_ring->setText(QString("ring    : %1 / %2 (peak %3)")
+                                         .arg(udp_link->ring_size())
+                                         .arg(udp_link->ring_capacity())
+                                         .arg(udp_link->ring_peak()));
+        ui->label_link_overflow->setText(QString("overflow: %1 | recorded %2 datagrams, %3 MB, dropped %4%5")
+                                             .arg(udp_link->overflow())
+                                             .arg(recorder->records())
+                                             .arg(recorder->bytes() / 1e6, 0, 'f', 1)
+                                             .arg(recorder->dropped())
+                                             .arg(recorder->is_failing() ? ", can't open segment, retrying" : ""));
+
+        const tcmd_t &in_flight = selected->in_flight();
+
+        if (in_flight.count > 0)
+        {
+            const tcmd_stats_t &s = selected->stats_of(in_flight.params[0].idx);
+            ui->label_link_tcmd->setText(QString("tcmd %1 : last %2 ms, mean %3 ms, max %4 ms, queued %5")
+                                             .arg(in_flight.params[0].idx)
+                                             .arg(s.last_ms)
+                                             .arg(s.count ? s.total_ms / qint64(s.count) : 0)
+                                             .arg(s.max_ms)
+                                             .arg(selected->queued()));
+        }
+
+        const LatencyHistogram &rtt_all = selected->rtt();
+        QString rtt = QString("rtt     : p50 %1 ms, p99 %2 ms, acked %3, retx %4, lost %5, pending %6")
+                          .arg(rtt_all.percentile(0.50) / 1000.0, 0, 'f', 1)
+                          .arg(rtt_all.percentile(0.99) / 1000.0, 0, 'f', 1)
+                          .arg(selected->acked())
+                          .arg(selected->retransmits())
+                          .arg(selected->lost())
+                          .arg(selected->pending());
+
+        if (!selected->acks_supported())
+        {
+            rtt += QString(", no acks, %1 sent once").arg(selected->unacknowledged());
+        }
+
+        if (selected->last_acked() != TCMD_LENGTH)
         {
-            ui->widget_em_plot->graph(i)->setData(tms, c[i]);
-            ui->widget_tof_plot->graph(i)->setData(tms, d[i]);
+            const LatencyHistogram &h = selected->rtt(tcmd_idx(selected->last_acked()));
+            rtt += QString(" | tcmd %1: p50 %2 ms, p99 %3 ms")
+                       .arg(selected->last_acked())
+                       .arg(h.percentile(0.50) / 1000.0, 0, 'f', 1)
+                       .arg(h.percentile(0.99) / 1000.0, 0, 'f', 1);
         }
 
-        ui->widget_plot_est0->graph(0)->setData(tms, d[0]);
-        ui->widget_plot_est1->graph(0)->setData(tms, d[1]);
-        ui->widget_plot_est2->graph(0)->setData(tms, d[2]);
-        ui->widget_plot_est3->graph(0)->setData(tms, d[3]);
-
-        ui->widget_plot_est0->graph(1)->setData(tms, kf_d[0]);
-        ui->widget_plot_est1->graph(1)->setData(tms, kf_d[1]);
-        ui->widget_plot_est2->graph(1)->setData(tms, kf_d[2]);
-        ui->widget_plot_est3->graph(1)->setData(tms, kf_d[3]);
-
-        ui->widget_plot_estv0->graph(0)->setData(tms, kf_v[0]);
-        ui->widget_plot_estv1->graph(0)->setData(tms, kf_v[1]);
-        ui->widget_plot_estv2->graph(0)->setData(tms, kf_v[2]);
-        ui->widget_plot_estv3->graph(0)->setData(tms, kf_v[3]);
-
-        ui->widget_plot_estv0->rescaleAxes();
-        ui->widget_plot_estv0->replot();
-        ui->widget_plot_estv1->rescaleAxes();
-        ui->widget_plot_estv1->replot();
-        ui->widget_plot_estv2->rescaleAxes();
-        ui->widget_plot_estv2->replot();
-        ui->widget_plot_estv3->rescaleAxes();
-        ui->widget_plot_estv3->replot();
-
-        ui->widget_plot_est0->rescaleAxes();
-        ui->widget_plot_est0->replot();
-        ui->widget_plot_est1->rescaleAxes();
-        ui->widget_plot_est1->replot();
-        ui->widget_plot_est2->rescaleAxes();
-        ui->widget_plot_est2->replot();
-        ui->widget_plot_est3->rescaleAxes();
-        ui->widget_plot_est3->replot();
-
-        ui->widget_em_plot->rescaleAxes();
-        ui->widget_em_plot->replot();
-
-        ui->widget_tof_plot->rescaleAxes();
-        ui->widget_tof_plot->replot();
+        ui->label_link_rtt->setText(rtt);
+
+        const LatencyHistogram &jitter = selected->arrival_jitter();
+        const LatencyHistogram &delay = selected->gs_delay();
+        ui->label_link_jitter->setText(QString("jitter  : arrival p50 %1 ms, p99 %2 ms, max %3 ms | gs delay p50 %4 ms, p99 %5 ms")
+                                           .arg(jitter.percentile(0.50) / 1000.0, 0, 'f', 2)
+                                           .arg(jitter.percentile(0.99) / 1000.0, 0, 'f', 2)
+                                           .arg(jitter.max() / 1000.0, 0, 'f', 2)
+                                           .arg(delay.percentile(0.50) / 1000.0, 0, 'f', 2)
+                                           .arg(delay.percentile(0.99) / 1000.0, 0, 'f', 2));
+
+        // Delay past the period over the window, overruns in the window/session
+        const ThreadMonitor &threads = selected->thread_health();
+        QLabel *thread_labels[FW_THREADS] = {ui->label_thread_dock, ui->label_thread_coil, ui->label_thread_telem,
+                                             ui->label_thread_tcmd, ui->label_thread_range};
+
+        for (int i = 0; i < FW_THREADS; i++)
+        {
+            const LatencyHistogram &h = threads.recent(fw_thread(i));
+
+            thread_labels[i]->setText(QString::asprintf("%-6s%6.2f%7.2f%7.1f%4u/%llu", fw_thread_name(fw_thread(i)),
+                                                        h.percentile(0.50) / 1000.0, h.percentile(0.99) / 1000.0,
+                                                        h.percentile(1.0) / 1000.0, threads.recent_overruns(fw_thread(i)),
+                                                        (unsigned long long)threads.overruns(fw_thread(i))));
+            thread_labels[i]->setStyleSheet(threads.alarms() & (1u << i) ? "color: #ff5e5e;" : "");
+        }
     });
 
-    timer_plot_mag->start(70);
+    timer_link_stats->start(500);
+
     manager = new QNetworkAccessManager(this);
 
-    connect(udp_socket, &QUdpSocket::bytesWritten,
-            this, &MainWindow::handleBytesWritten);
+    // One session per satellite, picked in the link status box
+    for (SessionManager *m : {sessions, replay_sessions})
+    {
+        connect(m, &SessionManager::sessionAdded, this, [this, m](SatelliteSession *session)
+        {
+            if (m == shown)
+            {
+                ui->comboBox_unit->addItem(session->name());
+            }
+        });
+    }
+    connect(ui->comboBox_unit, &QComboBox::currentIndexChanged, this, &MainWindow::select_unit);
+
+    // Recordings replay into sessions of their own, shown instead of the live
+    // ones while replaying
+    replay->set_sink([this](const telemetry_rx_t *frames, size_t n, int64_t now_ns)
+    {
+        replay_sessions->deliver(frames, n, now_ns);
+    });
+
+    // Once per replay tick, however many frames it took
+    connect(replay, &ReplayEngine::progress, this, [this](qint64 position_ns)
+    {
+        if (shown == replay_sessions && selected && selected->link().frames > 0)
+        {
+            update_telemetry_labels(selected->last_telemetry());
+        }
+
+        if (!ui->horizontalSlider_replay->isSliderDown())
+        {
+            ui->horizontalSlider_replay->setValue(int(position_ns / 1000000));
+        }
+
+        ui->label_replay_status->setText(QString("%1 / %2 s, %3 frames, %4 corrupt, %5 CRC mismatch")
+                                             .arg(position_ns * 1e-9, 0, 'f', 1)
+                                             .arg(replay->duration_ns() * 1e-9, 0, 'f', 1)
+                                             .arg(replay->frames())
+                                             .arg(replay->corrupt())
+                                             .arg(replay->crc_mismatches()));
+    });
+    connect(replay, &ReplayEngine::finished, this, [this]()
+    {
+        ui->pushButton_replay_play->setChecked(false);
+    });
+
+    connect(ui->horizontalSlider_replay, &QSlider::sliderReleased, this, [this]()
+    {
+        // The plots restart at the new position
+        replay_sessions->clear_telemetry();
+        replay->seek(qint64(ui->horizontalSlider_replay->value()) * 1000000);
+
+        if (shown == replay_sessions)
+        {
+            select_unit(ui->comboBox_unit->currentIndex());
+        }
+    });
+    connect(ui->comboBox_replay_speed, &QComboBox::currentIndexChanged, this, [this](int index)
+    {
+        // 1x, 2x, 10x, 100x, max
+        static const double speeds[] = {1, 2, 10, 100, 0};
+
+        if (index >= 0 && index < int(sizeof(speeds) / sizeof(speeds[0])))
+        {
+            replay->set_speed(speeds[index]);
+        }
+    });
+
+    // Receive and decode on a dedicated I/O thread, the GUI drains in batches
+    udp_link->set_recorder(recorder);
+    udp_link->moveToThread(&rx_thread);
+    connect(&rx_thread, &QThread::finished, udp_link, &QObject::deleteLater);
+    connect(udp_link, &UdpLink::telemetryReady, this, &MainWindow::receiveMessage);
+    rx_thread.start();
+
+    // Every datagram goes to the flight recorder, written on its own thread
+    recorder->moveToThread(&recorder_thread);
+    connect(&recorder_thread, &QThread::finished, recorder, &QObject::deleteLater);
+    recorder_thread.start();
 }
 
 MainWindow::~MainWindow()
 {
+    rx_thread.quit();
+    rx_thread.wait();
+
+    // After the link, so nothing is recorded anymore
+    recorder_thread.quit();
+    recorder_thread.wait();
+
     delete ui;
 }
 
-void MainWindow::handleBytesWritten(qint64 bytes)
+void MainWindow::select_unit(int index)
 {
-    Q_UNUSED(bytes);
-    isSending = false;
+    if (index < 0 || index >= shown->all().size())
+    {
+        return;
+    }
+
+    selected = shown->all()[index];
 
-    // Add small delay if needed (10ms)
-    QTimer::singleShot(10, this, &MainWindow::processMessageQueue);
+    // Plots and labels follow the selected unit
+    plot_scheduler->set_store(&selected->telemetry());
+    plot_scheduler->set_history(&selected->history(), &selected->lod());
+    plot_scheduler->refresh();
+
+    if (selected->link().frames > 0)
+    {
+        update_telemetry_labels(selected->last_telemetry());
+    }
 }
 
-void MainWindow::processMessageQueue()
+void MainWindow::show_sessions(SessionManager *m)
 {
-    if (!messageQueue.isEmpty() && !isSending) {
-        isSending = true;
-        auto message = messageQueue.dequeue();
+    if (m == shown)
+    {
+        return;
+    }
+
+    shown = m;
+    selected = nullptr;
+    plot_scheduler->set_store(nullptr);
+    plot_scheduler->set_history(nullptr, nullptr);
 
-        QString formatted = QString("$%1:%2#")
-                                .arg(message.first)
-                                .arg(message.second, 0, 'f', 3);
+    {
+        QSignalBlocker block(ui->comboBox_unit);
+        ui->comboBox_unit->clear();
 
-        udp_socket->writeDatagram(formatted.toUtf8(), udp_server_ip, udp_server_port);
+        for (SatelliteSession *session : m->all())
+        {
+            ui->comboBox_unit->addItem(session->name());
+        }
+    }
+
+    select_unit(ui->comboBox_unit->currentIndex());
+}
+
+int MainWindow::tcmd_pacing() const
+{
+    bool ok;
+    int pacing = ui->textEdit_tcmd_pacing->toPlainText().toInt(&ok);
+
+    return ok && pacing >= 0 ? pacing : TCMD_PACING_MILLIS;
+}
+
+void MainWindow::enqueue_tcmd(const tcmd_param_t *params, int count)
+{
+    if (shown != sessions)
+    {
+        qDebug() << "Showing a replay, telecommand" << params[0].idx << "not sent";
+        return;
+    }
+
+    sessions->set_pacing(tcmd_pacing());
+
+    if (ui->checkBox_broadcast->isChecked())
+    {
+        for (SatelliteSession *session : sessions->all())
+        {
+            session->enqueue(params, count);
+        }
+    }
+    else if (selected)
+    {
+        selected->enqueue(params, count);
+    }
+    else
+    {
+        qDebug() << "No unit to send telecommand" << params[0].idx << "to";
     }
 }
 
 void MainWindow::sendMessage(enum tcmd_idx idx, double data)
 {
-    QString message = QString("$%1:%2#").arg(idx).arg(data, 0, 'f', 3);
-    qDebug() << message;
-    QByteArray byteData = message.toUtf8();
-    udp_socket->writeDatagram(byteData, udp_server_ip, udp_server_port);
-    QThread::msleep(200);
+    tcmd_param_t param = {idx, data};
+
+    enqueue_tcmd(&param, 1);
 }
 
-void MainWindow::receiveMessage()
+void MainWindow::stage_parameter(enum tcmd_idx idx, double data)
 {
-    while (udp_socket->hasPendingDatagrams())
+    for (tcmd_param_t &param : tcmd_staged)
     {
-        QByteArray buffer;
-        buffer.resize(int(udp_socket->pendingDatagramSize()));
+        if (param.idx == idx)
+        {
+            param.value = data;
+            return;
+        }
+    }
+
+    tcmd_staged.append({idx, data});
+}
 
-        QHostAddress tpi_ip;
-        quint16 tpi_port;
-        udp_socket->readDatagram(buffer.data(), buffer.size(), &tpi_ip, &tpi_port);
+void MainWindow::flush_parameters()
+{
+    tcmd_t cmd = {};
+    cmd.seq = 0xFFFF; // Widest sequence number, only used for the size check
+
+    // Pack as many parameters per datagram as fit, normally all of them
+    for (const tcmd_param_t &param : std::as_const(tcmd_staged))
+    {
+        if (cmd.count == TCMD_BATCH_MAX)
+        {
+            qDebug() << "Parameter set does not fit into one telecommand, it is not applied atomically";
+            enqueue_tcmd(cmd.params, cmd.count);
+            cmd.count = 0;
+        }
 
-        //qDebug() << "Received from" << tpi_ip.toString() << ":" << tpi_port << "->" << QString::fromUtf8(buffer);
-        telemetry_t t;
+        cmd.params[cmd.count++] = param;
 
-        if(parse_telemetry(QString::fromUtf8(buffer), t))
+        if (cmd.count > 1 && format_tcmd(cmd).size() > MAX_BUFFER_SIZE_TCMD)
         {
-            populate_telemetry(t);
+            qDebug() << "Parameter set does not fit into one telecommand, it is not applied atomically";
+            enqueue_tcmd(cmd.params, cmd.count - 1);
+            cmd.params[0] = param;
+            cmd.count = 1;
         }
     }
+
+    if (cmd.count > 0)
+    {
+        enqueue_tcmd(cmd.params, cmd.count);
+    }
+
+    tcmd_staged.clear();
+}
+
+void MainWindow::receiveMessage()
+{
+    const quint64 frames = selected ? selected->link().frames : 0;
+
+    sessions->dispatch();
+
+    // Labels only show the latest frame of the selected unit
+    if (shown == sessions && selected && selected->link().frames != frames)
+    {
+        update_telemetry_labels(selected->last_telemetry());
+    }
 }
 
 void MainWindow::on_pushButton_em0_toggled(bool checked)
@@ -624,10 +764,11 @@ void MainWindow::on_pushButton_em3_toggled(bool checked)
 }
 void MainWindow::on_pushButton_udp_connect_toggled(bool checked)
 {
-    QString ip_str = ui->textEdit_udp_ip->toPlainText();
+    // One or more units, e.g. "tamariw-a.local, 192.168.1.21"
+    QStringList hosts = ui->textEdit_udp_ip->toPlainText().split(',', Qt::SkipEmptyParts);
     QString port_str = ui->textEdit_udp_port->toPlainText();
 
-    if (ip_str.isEmpty() || port_str.isEmpty()) {
+    if (hosts.isEmpty() || port_str.isEmpty()) {
         qDebug() << "Please enter a valid hostname/IP and port.";
         return;
     }
@@ -641,80 +782,87 @@ void MainWindow::on_pushButton_udp_connect_toggled(bool checked)
         return;
     }
 
-    // Resolve hostname (including .local) to IP
-    QHostInfo::lookupHost(ip_str, this, [=](const QHostInfo &hostInfo) {
-        if (hostInfo.error() != QHostInfo::NoError) {
-            qDebug() << "Hostname resolution failed:" << hostInfo.errorString();
-            QPixmap pix(":/assets/router.png");
-            ui->pushButton_udp_connect->setIcon(pix);
-            ui->pushButton_udp_connect->setChecked(false);
-            return;
+    if (!checked) {
+        // Disconnect UDP
+        for (SatelliteSession *session : sessions->all()) {
+            session->send_raw("Bye from Qt");
         }
 
-        QList<QHostAddress> addresses = hostInfo.addresses();
-        if (addresses.isEmpty()) {
-            qDebug() << "No IP address found for" << ip_str;
-            QPixmap pix(":/assets/router.png");
-            ui->pushButton_udp_connect->setIcon(pix);
-            ui->pushButton_udp_connect->setChecked(false);
-            return;
-        }
+        QMetaObject::invokeMethod(udp_link, &UdpLink::close);
+        QMetaObject::invokeMethod(recorder, &FlightRecorder::stop);
+        qDebug() << "UDP Disabled.";
+        QPixmap pix(":/assets/router.png");
+        ui->pushButton_udp_connect->setIcon(pix);
+        return;
+    }
+
+    QString portText = ui->textEdit_udp_port_local->toPlainText().trimmed();
+    bool ok;
+    quint16 local_port = portText.toUShort(&ok);
+
+    // Start UDP connection, binding is quick so wait for the I/O thread
+    bool bound = false;
+    QMetaObject::invokeMethod(udp_link, [=]() { return udp_link->open(local_port); },
+                              Qt::BlockingQueuedConnection, &bound);
 
-        // Use the first resolved IP (IPv4 preferred)
-        QHostAddress serverIp;
-        for (const QHostAddress &addr : addresses) {
-            if (addr.protocol() == QAbstractSocket::IPv4Protocol) {
-                serverIp = addr;
-                break;
+    if (!bound) {
+        qDebug() << "Failed to bind UDP socket.";
+        QPixmap pix(":/assets/router.png");
+        ui->pushButton_udp_connect->setIcon(pix);
+        ui->pushButton_udp_connect->setChecked(false);
+        return;
+    }
+
+    // Units that are not listed still get a session with their first frame
+    sessions->set_port(serverPort);
+
+    QString record_dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/recordings";
+    QMetaObject::invokeMethod(recorder, [=]() { recorder->start(record_dir); });
+
+    QPixmap pix(":/assets/wifi_on.png");
+    ui->pushButton_udp_connect->setIcon(pix);
+
+    for (const QString &host : std::as_const(hosts)) {
+        QString ip_str = host.trimmed();
+
+        // Resolve hostname (including .local) to IP
+        QHostInfo::lookupHost(ip_str, this, [=](const QHostInfo &hostInfo) {
+            if (hostInfo.error() != QHostInfo::NoError) {
+                qDebug() << "Hostname resolution failed:" << ip_str << hostInfo.errorString();
+                return;
             }
-        }
-        if (serverIp.isNull()) {
-            serverIp = addresses.first(); // Fallback to IPv6 if no IPv4
-        }
 
-        udp_server_ip = serverIp;
-        udp_server_port = serverPort;
-        qDebug() << "Resolved server:" << ip_str << "->" << udp_server_ip.toString() << ":" << udp_server_port;
-
-        if (checked) {
-            QString portText = ui->textEdit_udp_port_local->toPlainText().trimmed();
-            bool ok;
-            quint16 local_port = portText.toUShort(&ok);
-
-            // Start UDP connection
-            if (udp_socket->bind(QHostAddress::AnyIPv4,  local_port)) {
-                connect(udp_socket, &QUdpSocket::readyRead, this, &MainWindow::receiveMessage);
-                qDebug() << "UDP Enabled. Receiving from:" << udp_socket->localAddress().toString() << udp_socket->localPort();
-
-                QByteArray data = "Hello from Qt";
-                udp_socket->writeDatagram(data, udp_server_ip, udp_server_port);
-
-                QPixmap pix(":/assets/wifi_on.png");
-                ui->pushButton_udp_connect->setIcon(pix);
-            } else {
-                qDebug() << "Failed to bind UDP socket.";
-                QPixmap pix(":/assets/router.png");
-                ui->pushButton_udp_connect->setIcon(pix);
-                ui->pushButton_udp_connect->setChecked(false);
+            QList<QHostAddress> addresses = hostInfo.addresses();
+            if (addresses.isEmpty()) {
+                qDebug() << "No IP address found for" << ip_str;
+                return;
             }
-        } else {
-            // Disconnect UDP
-            QByteArray data = "Bye from Qt";
-            udp_socket->writeDatagram(data, udp_server_ip, udp_server_port);
-
-            disconnect(udp_socket, &QUdpSocket::readyRead, this, &MainWindow::receiveMessage);
-            udp_socket->close();
-            qDebug() << "UDP Disabled.";
-            QPixmap pix(":/assets/router.png");
-            ui->pushButton_udp_connect->setIcon(pix);
-        }
-    });
+
+            // Use the first resolved IP (IPv4 preferred)
+            QHostAddress serverIp;
+            for (const QHostAddress &addr : addresses) {
+                if (addr.protocol() == QAbstractSocket::IPv4Protocol) {
+                    serverIp = addr;
+                    break;
+                }
+            }
+            if (serverIp.isNull()) {
+                serverIp = addresses.first(); // Fallback to IPv6 if no IPv4
+            }
+
+            qDebug() << "Resolved server:" << ip_str << "->" << serverIp.toString() << ":" << serverPort;
+
+            SatelliteSession *session = sessions->add(serverIp, serverPort);
+            session->send_raw("Hello from Qt");
+        });
+    }
 }
 
 void MainWindow::on_pushButton_em_gain_clicked()
 {
-    sendMessage(TCMD_EM_KP, ui->textEdit_em_kp->toPlainText().toDouble());
-    sendMessage(TCMD_EM_KI, ui->textEdit_em_ki->toPlainText().toDouble());
+    stage_parameter(TCMD_EM_KP, ui->textEdit_em_kp->toPlainText().toDouble());
+    stage_parameter(TCMD_EM_KI, ui->textEdit_em_ki->toPlainText().toDouble());
+    flush_parameters();
 }
 
 void MainWindow::on_pushButton_em_pow_clicked(bool checked)
@@ -726,10 +874,11 @@ void MainWindow::on_pushButton_em_pow_clicked(bool checked)
 
         QPixmap pix(":/assets/em_on.png");
 
-        if (em_state[0] == EM_STANDBY){ ui->label_em0->setPixmap(pix); sendMessage(TCMD_EM0, ui->textEdit_em0->toPlainText().toDouble()); }
-        if (em_state[1] == EM_STANDBY){ ui->label_em1->setPixmap(pix); sendMessage(TCMD_EM1, ui->textEdit_em1->toPlainText().toDouble()); }
-        if (em_state[2] == EM_STANDBY){ ui->label_em2->setPixmap(pix); sendMessage(TCMD_EM2, ui->textEdit_em2->toPlainText().toDouble()); }
-        if (em_state[3] == EM_STANDBY){ ui->label_em3->setPixmap(pix); sendMessage(TCMD_EM3, ui->textEdit_em3->toPlainText().toDouble()); }
+        if (em_state[0] == EM_STANDBY){ ui->label_em0->setPixmap(pix); stage_parameter(TCMD_EM0, ui->textEdit_em0->toPlainText().toDouble()); }
+        if (em_state[1] == EM_STANDBY){ ui->label_em1->setPixmap(pix); stage_parameter(TCMD_EM1, ui->textEdit_em1->toPlainText().toDouble()); }
+        if (em_state[2] == EM_STANDBY){ ui->label_em2->setPixmap(pix); stage_parameter(TCMD_EM2, ui->textEdit_em2->toPlainText().toDouble()); }
+        if (em_state[3] == EM_STANDBY){ ui->label_em3->setPixmap(pix); stage_parameter(TCMD_EM3, ui->textEdit_em3->toPlainText().toDouble()); }
+        flush_parameters();
     }
     else
     {
@@ -742,6 +891,7 @@ void MainWindow::on_pushButton_em_pow_clicked(bool checked)
         if (em_state[2] == EM_STANDBY){ ui->label_em2->setPixmap(pix); }
         if (em_state[3] == EM_STANDBY){ ui->label_em3->setPixmap(pix); }
 
+        // Safety stops go one per datagram, any firmware takes those
         sendMessage(TCMD_EM0_STOP, 0.0);
         sendMessage(TCMD_EM1_STOP, 0.0);
         sendMessage(TCMD_EM2_STOP, 0.0);
@@ -892,9 +1042,10 @@ void MainWindow::on_pushButton_flash_2_clicked()
 }
 void MainWindow::on_pushButton_em_gain_2_clicked()
 {
-    sendMessage(TCMD_KF_Q00, ui->textEdit_kf_q00->toPlainText().toDouble());
-    sendMessage(TCMD_KF_Q11, ui->textEdit_kf_q11->toPlainText().toDouble());
-    sendMessage(TCMD_KF_R, ui->textEdit_kf_r->toPlainText().toDouble());
+    stage_parameter(TCMD_KF_Q00, ui->textEdit_kf_q00->toPlainText().toDouble());
+    stage_parameter(TCMD_KF_Q11, ui->textEdit_kf_q11->toPlainText().toDouble());
+    stage_parameter(TCMD_KF_R, ui->textEdit_kf_r->toPlainText().toDouble());
+    flush_parameters();
 
     ui->tabWidget->setCurrentWidget(ui->tab_kf_pos);
 }
@@ -1016,3 +1167,55 @@ void MainWindow::on_pushButton_send_dist_sp_1_clicked()
     sendMessage(TCMD_DOCK_DISTANCE_SP, ui->textEdit_dock_dist_sp->toPlainText().toDouble());
 }
 
+void MainWindow::on_pushButton_replay_open_clicked()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/recordings";
+    QString fileName = QFileDialog::getOpenFileName(
+        this,
+        tr("Open Recording"),
+        dir,
+        tr("Recordings (*.rec);;All Files (*)")
+        );
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    ui->pushButton_replay_play->setChecked(false);
+
+    if (!replay->open(fileName)) {
+        QMessageBox::warning(this, tr("Replay"), tr("Not a readable recording:\n%1").arg(fileName));
+        return;
+    }
+
+    // Units of earlier recordings keep their session, with fresh telemetry
+    replay_sessions->clear_telemetry();
+
+    ui->horizontalSlider_replay->setRange(0, int(replay->duration_ns() / 1000000));
+    ui->horizontalSlider_replay->setValue(0);
+    ui->label_replay_file->setText(QFileInfo(fileName).fileName());
+    ui->label_replay_status->setText(QString("0.0 / %1 s, %2 records")
+                                         .arg(replay->duration_ns() * 1e-9, 0, 'f', 1)
+                                         .arg(replay->recording().count()));
+
+    show_sessions(replay_sessions);
+    select_unit(ui->comboBox_unit->currentIndex());
+}
+
+void MainWindow::on_pushButton_replay_play_toggled(bool checked)
+{
+    if (checked) {
+        show_sessions(replay_sessions);
+        replay->play();
+        ui->pushButton_replay_play->setText("PAUSE");
+    } else {
+        replay->pause();
+        ui->pushButton_replay_play->setText("PLAY");
+    }
+}
+
+void MainWindow::on_pushButton_replay_live_clicked()
+{
+    ui->pushButton_replay_play->setChecked(false);
+    show_sessions(sessions);
+}
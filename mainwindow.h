@@ -4,35 +4,31 @@
 #include <QMainWindow>
 #include <QUdpSocket>
 #include <QQueue>
+#include <QThread>
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QFile>
 #include <QUrl>
 
-// Satellite docking states.
-// Please make sure it is identical to the one on embedded firmware.
-enum dock_state
-{
-    DOCK_STATE_START,   // Indicates the start of docking sequence (received from third party)
-    DOCK_STATE_IDLE,    // Do nothing at all
-    DOCK_STATE_CAPTURE, // Passive coil actuation to bring satellites together
-    DOCK_STATE_CONTROL, // Soft docking control with position and velocity feedback
-    DOCK_STATE_LATCH,   // Extra push to overcome latch friction
-    DOCK_STATE_UNLATCH, // Repel latched satellites
-    DOCK_STATE_ABORT    // Abort the docking sequence under unsafe conditions
-};
+#include "sat_config.h"
+#include "telemetry.h"
+#include "udp_link.h"
+#include "telecommand.h"
+#include "session_manager.h"
+#include "replay_engine.h"
+#include "replot_scheduler.h"
 
-typedef struct
-{
-    float d[4];    // ToF measurements [mm]
-    float c[4];    // Electromagnet current feedback [mA]
-    float dt[5];    // Thread periods [ms]
-    float kf_d[4]; // Kalman Filter distance estimates
-    float kf_v[4]; // Kalman Filter velocity estimates
-    enum dock_state state; // Current docking state
-    uint16_t crc;
-} telemetry_t;
+// Decoded frames the I/O thread can buffer while the GUI is busy,
+// about 6 s of telemetry from 8 satellites
+#define RX_RING_CAPACITY 1024
+
+// Samples kept per channel for plotting
+#define TELEMETRY_WINDOW 250
+
+// Plot refresh interval, stretched up to the max when replots get slow
+#define PLOT_PERIOD_MILLIS 70
+#define PLOT_PERIOD_MAX_MILLIS 1000
 
 typedef enum
 {
@@ -41,55 +37,6 @@ typedef enum
     EM_STANDBY
 } em_state_t;
 
-// Add/remove new/obsolete telecommands as enum elements.
-// Please make sure it is identical to the one on embedded firmware.
-enum tcmd_idx
-{
-    // Coil PI controller gains
-    TCMD_EM_KP,
-    TCMD_EM_KI,
-
-    // Coil control set-points
-    TCMD_EM0,
-    TCMD_EM1,
-    TCMD_EM2,
-    TCMD_EM3,
-
-    // Coil enable/disable flags
-    TCMD_EM0_STOP,
-    TCMD_EM1_STOP,
-    TCMD_EM2_STOP,
-    TCMD_EM3_STOP,
-    TCMD_EM_STOP_ALL,
-
-    // KF noise covariances
-    TCMD_KF_R,
-    TCMD_KF_Q00,
-    TCMD_KF_Q11,
-
-    // Docking configurable parameters
-    TCMD_DOCK_KP,
-    TCMD_DOCK_KI,
-    TCMD_DOCK_KD,
-    TCMD_DOCK_KF,
-    TCMD_DOCK_LATCH_CURRENT,
-    TCMD_DOCK_UNLATCH_CURRENT,
-    TCMD_DOCK_VELOCITY_SP,
-    TCMD_DOCK_DISTANCE_SP,
-
-    // Docking states
-    TCMD_DOCK_STATE_START,
-    TCMD_DOCK_STATE_IDLE,
-    TCMD_DOCK_STATE_LATCH,
-    TCMD_DOCK_STATE_ABORT,
-    TCMD_DOCK_STATE_CAPTURE,
-    TCMD_DOCK_STATE_CONTROL,
-    TCMD_DOCK_STATE_UNLATCH,
-
-    // Number of enumerators
-    TCMD_LENGTH
-};
-
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -104,6 +51,12 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Collects telecommand parameters, flush_parameters() sends them together
+    // in one datagram so the firmware applies them in the same TCMD cycle
+    void stage_parameter(enum tcmd_idx idx, double data);
+
+    void flush_parameters();
+
 private slots:
     void on_pushButton_em0_toggled(bool checked);
 
@@ -117,10 +70,6 @@ private slots:
 
     void on_pushButton_udp_connect_toggled(bool checked);
 
-    void handleBytesWritten(qint64 bytes);
-
-    void processMessageQueue();
-
     void on_pushButton_em3_toggled(bool checked);
 
     void on_pushButton_em_gain_clicked();
@@ -173,21 +122,42 @@ private slots:
 
     void on_pushButton_send_dist_sp_1_clicked();
 
+    void on_pushButton_replay_open_clicked();
+
+    void on_pushButton_replay_play_toggled(bool checked);
+
+    void on_pushButton_replay_live_clicked();
+
 private:
-    void populate_telemetry(const telemetry_t &t);
+    void update_telemetry_labels(const telemetry_t &t);
+
+    // Queues a telecommand for the selected unit, or for all of them
+    void enqueue_tcmd(const tcmd_param_t *params, int count);
+
+    int tcmd_pacing() const;
+
+    void select_unit(int index);
 
-    QVector<double> tms, d[4], c[4], kf_d[4], kf_v[4];
+    // Lists the units of m in the unit box, the live or the replayed ones
+    void show_sessions(SessionManager *m);
     em_state_t em_state[4] = {EM_OFF, EM_OFF, EM_OFF, EM_OFF};
 
     QString hexFilePath;
     QNetworkAccessManager *manager;
 
     Ui::MainWindow *ui;
-    QUdpSocket *udp_socket;
-    QHostAddress udp_server_ip;
-    quint16 udp_server_port;
-    QTimer *timer_plot_mag;
-    QQueue<QPair<enum tcmd_idx, double>> messageQueue;
-    bool isSending = false;
+    QThread rx_thread;
+    UdpLink *udp_link;
+    QThread recorder_thread;
+    FlightRecorder *recorder;
+    SessionManager *sessions;
+    ReplayEngine *replay;
+    SessionManager *replay_sessions;
+    SessionManager *shown;
+    SatelliteSession *selected = nullptr;
+    uint32_t thread_alarms_shown = 0; // Period labels currently shown in red
+    ReplotScheduler *plot_scheduler;
+    QTimer *timer_link_stats;
+    QVector<tcmd_param_t> tcmd_staged;
 };
 #endif // MAINWINDOW_H
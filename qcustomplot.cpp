@@ -25,6 +25,18 @@
 
 #include "qcustomplot.h"
 
+// vectorized adaptive sampling of QCPGraph, SSE2 is part of x86-64, AVX is checked at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#  define QCP_SIMD_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define QCP_TARGET_AVX
+#  else
+#    define QCP_TARGET_AVX __attribute__((target("avx")))
+#  endif
+#endif
+
 
 /* including file 'src/vector2d.cpp'       */
 /* modified 2022-11-06T12:45:56, size 7973 */
@@ -20835,6 +20847,10 @@ QCPGraphData::QCPGraphData(double key, double value) :
   (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
   separated.
   
+  Instead of its own data container, a graph can draw the data points of a \ref QCPGraphDataSource,
+  e.g. a \ref QCPGraphSpanDataSource over arrays that belong to the application, see \ref
+  setDataSource.
+  
   \section qcpgraph-appearance Changing the appearance
   
   The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
@@ -20862,6 +20878,14 @@ QCPGraphData::QCPGraphData(double key, double value) :
   regular \ref setData or \ref addData methods.
 */
 
+/*! \fn QSharedPointer<QCPGraphDataSource> QCPGraph::dataSource() const
+  
+  Returns the data source the graph draws instead of its data container, or a null pointer if it
+  draws its data container.
+  
+  \see setDataSource
+*/
+
 /* end of documentation of inline functions */
 
 /*!
@@ -20916,6 +20940,7 @@ QCPGraph::~QCPGraph()
 void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 {
   mDataContainer = data;
+  mDataSource.clear();
 }
 
 /*! \overload
@@ -20935,6 +20960,28 @@ void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &value
   addData(keys, values, alreadySorted);
 }
 
+/*!
+  Makes the graph draw the data points of \a source instead of its data container. Drawing,
+  selection, axis rescaling and the \ref QCPPlottableInterface1D then work on \a source, and
+  selections refer to its indices. Several graphs may share one source.
+  
+  \ref data, \ref setData(const QVector<double>&, const QVector<double>&, bool) "setData(keys, values)"
+  and \ref addData still access the graph's data container, which isn't drawn while a source is set.
+  Scatters of a source are thinned out by \ref setScatterSkip only, not by the adaptive sampling.
+  
+  Pass a null pointer, or call \ref setData(QSharedPointer<QCPGraphDataContainer>), to draw the data
+  container again.
+  
+  To draw arrays that belong to the application without copying them, see \ref
+  QCPGraphSpanDataSource.
+  
+  \see dataSource
+*/
+void QCPGraph::setDataSource(QSharedPointer<QCPGraphDataSource> source)
+{
+  mDataSource = source;
+}
+
 /*!
   Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
   \ref lsNone and \ref setScatterStyle to the desired scatter style.
@@ -21091,20 +21138,25 @@ void QCPGraph::addData(double key, double value)
 */
 double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+  if ((onlySelectable && mSelectable == QCP::stNone) || dataCount() == 0)
     return -1;
   if (!mKeyAxis || !mValueAxis)
     return -1;
   
   if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()) || mParentPlot->interactions().testFlag(QCP::iSelectPlottablesBeyondAxisRect))
   {
-    QCPGraphDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
-    double result = pointDistance(pos, closestDataPoint);
-    if (details)
+    int pointIndex;
+    double result;
+    if (mDataSource)
+      result = pointDistance(pos, pointIndex);
+    else
     {
-      int pointIndex = int(closestDataPoint-mDataContainer->constBegin());
-      details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
+      QCPGraphDataContainer::const_iterator closestDataPoint = mDataContainer->constEnd();
+      result = pointDistance(pos, closestDataPoint);
+      pointIndex = int(closestDataPoint-mDataContainer->constBegin());
     }
+    if (details)
+      details->setValue(QCPDataSelection(QCPDataRange(pointIndex, pointIndex+1)));
     return result;
   } else
     return -1;
@@ -21113,20 +21165,160 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (mDataSource)
+    return mDataSource->keyRange(foundRange, inSignDomain);
   return mDataContainer->keyRange(foundRange, inSignDomain);
 }
 
 /* inherits documentation from base class */
 QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (mDataSource)
+    return mDataSource->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
+/*!
+  \copydoc QCPPlottableInterface1D::dataCount
+*/
+int QCPGraph::dataCount() const
+{
+  if (mDataSource)
+    return mDataSource->size();
+  return QCPAbstractPlottable1D<QCPGraphData>::dataCount();
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainKey
+*/
+double QCPGraph::dataMainKey(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainKey(index);
+  if (index >= 0 && index < mDataSource->size())
+    return mDataSource->keyAt(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataSortKey
+*/
+double QCPGraph::dataSortKey(int index) const
+{
+  return dataMainKey(index);
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataMainValue
+*/
+double QCPGraph::dataMainValue(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainValue(index);
+  if (index >= 0 && index < mDataSource->size())
+    return mDataSource->valueAt(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataValueRange
+*/
+QCPRange QCPGraph::dataValueRange(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataValueRange(index);
+  const double value = dataMainValue(index);
+  return QCPRange(value, value);
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::dataPixelPosition
+*/
+QPointF QCPGraph::dataPixelPosition(int index) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataPixelPosition(index);
+  if (index >= 0 && index < mDataSource->size())
+    return coordsToPixels(mDataSource->keyAt(index), mDataSource->valueAt(index));
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return QPointF();
+}
+
+/*!
+  Implements a rect-selection algorithm assuming the data points are point-like, for the data
+  container as well as a data source (see \ref setDataSource).
+
+  \seebaseclassmethod
+*/
+QCPDataSelection QCPGraph::selectTestRect(const QRectF &rect, bool onlySelectable) const
+{
+  if (!mDataSource)
+    return QCPAbstractPlottable1D<QCPGraphData>::selectTestRect(rect, onlySelectable);
+  
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataSource->isEmpty())
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
+  
+  // convert rect given in pixels to ranges given in plot coordinates:
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  QCPRange keyRange(key1, key2); // QCPRange normalizes internally so we don't have to care about whether key1 < key2
+  QCPRange valueRange(value1, value2);
+  const int begin = mDataSource->findBegin(keyRange.lower, false);
+  const int end = mDataSource->findEnd(keyRange.upper, false);
+  
+  int currentSegmentBegin = -1; // -1 means we're currently not in a segment that's contained in rect
+  for (int i=begin; i<end; ++i)
+  {
+    const bool contained = valueRange.contains(mDataSource->valueAt(i)) && keyRange.contains(mDataSource->keyAt(i));
+    if (currentSegmentBegin == -1)
+    {
+      if (contained) // start segment
+        currentSegmentBegin = i;
+    } else if (!contained) // segment just ended
+    {
+      result.addDataRange(QCPDataRange(currentSegmentBegin, i), false);
+      currentSegmentBegin = -1;
+    }
+  }
+  // process potential last segment:
+  if (currentSegmentBegin != -1)
+    result.addDataRange(QCPDataRange(currentSegmentBegin, end), false);
+  
+  result.simplify();
+  return result;
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::findBegin
+*/
+int QCPGraph::findBegin(double sortKey, bool expandedRange) const
+{
+  if (mDataSource)
+    return mDataSource->findBegin(sortKey, expandedRange);
+  return QCPAbstractPlottable1D<QCPGraphData>::findBegin(sortKey, expandedRange);
+}
+
+/*!
+  \copydoc QCPPlottableInterface1D::findEnd
+*/
+int QCPGraph::findEnd(double sortKey, bool expandedRange) const
+{
+  if (mDataSource)
+    return mDataSource->findEnd(sortKey, expandedRange);
+  return QCPAbstractPlottable1D<QCPGraphData>::findEnd(sortKey, expandedRange);
+}
+
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
   QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
@@ -21248,18 +21440,31 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
 {
   if (!lines) return;
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> lineData;
+  if (mDataSource)
   {
-    lines->clear();
-    return;
+    int begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getSourceLineData(&lineData, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getOptimizedLineData(&lineData, begin, end);
   }
   
-  QVector<QCPGraphData> lineData;
-  if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
-  
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData (significantly simplifies following processing)
     std::reverse(lineData.begin(), lineData.end());
 
@@ -21293,17 +21498,29 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
   
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> data;
+  if (mDataSource)
   {
-    scatters->clear();
-    return;
+    int begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getSourceScatterData(&data, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getOptimizedScatterData(&data, begin, end);
   }
   
-  QVector<QCPGraphData> data;
-  getOptimizedScatterData(&data, begin, end);
-  
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
     std::reverse(data.begin(), data.end());
   
@@ -21681,136 +21898,531 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &line
   }
 }
 
+namespace {
+
 /*! \internal
 
-  Returns via \a lineData the data points that need to be visualized for this graph when plotting
-  graph lines, taking into consideration the currently visible axis ranges and, if \ref
-  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
-  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
-  getDataSegments).
+  Advances \a it over the data points up to \a end whose key is smaller than \a keyLimit, i.e. that
+  fall into the current pixel interval of \ref QCPGraph::getOptimizedLineData, and expands \a
+  minValue and \a maxValue by their values. Returns the first data point beyond the interval.
 
-  This method is used by \ref getLines to retrieve the basic working set of data.
+  The comparisons are those of the original per-point loop: a value only replaces \a minValue or \a
+  maxValue if it is strictly smaller or larger, so NaN values are skipped and, of equal values, the
+  first one is kept.
+*/
+typedef const QCPGraphData *(*QCPIntervalScan)(const QCPGraphData *it, const QCPGraphData *end, double keyLimit, double &minValue, double &maxValue);
 
-  \see getOptimizedScatterData
+const QCPGraphData *qcpScanIntervalScalar(const QCPGraphData *it, const QCPGraphData *end, double keyLimit, double &minValue, double &maxValue)
+{
+  while (it != end && it->key < keyLimit)
+  {
+    if (it->value < minValue)
+      minValue = it->value;
+    else if (it->value > maxValue)
+      maxValue = it->value;
+    ++it;
+  }
+  return it;
+}
+
+/*! \internal
+
+  The interval scan of \ref qcpScanIntervalScalar for data points stored as separate \a keys and \a
+  values arrays (see \ref QCPGraphSpanDataSource). Works on indices and returns the index of the
+  first data point beyond the interval.
 */
-void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+typedef int (*QCPSoaIntervalScan)(const double *keys, const double *values, int it, int end, double keyLimit, double &minValue, double &maxValue);
+
+int qcpScanSoaIntervalScalar(const double *keys, const double *values, int it, int end, double keyLimit, double &minValue, double &maxValue)
 {
-  if (!lineData) return;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (begin == end) return;
-  
-  int dataCount = int(end-begin);
-  int maxCount = (std::numeric_limits<int>::max)();
-  if (mAdaptiveSampling)
+  while (it != end && keys[it] < keyLimit)
   {
-    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
-    if (2*keyPixelSpan+2 < static_cast<double>((std::numeric_limits<int>::max)()))
-      maxCount = int(2*keyPixelSpan+2);
+    if (values[it] < minValue)
+      minValue = values[it];
+    else if (values[it] > maxValue)
+      maxValue = values[it];
+    ++it;
   }
-  
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  return it;
+}
+
+/*! \internal
+
+  Expands \a lower and \a upper by the finite ones of \a values from \a begin to \a end, with the
+  comparisons of \ref QCPDataContainer::valueRange: a value only replaces a bound if it is strictly
+  smaller or larger. Start with \a lower at +Inf and \a upper at -Inf, they stay there if there is
+  no finite value.
+*/
+typedef void (*QCPValueRangeScan)(const double *values, int begin, int end, double &lower, double &upper);
+
+void qcpScanValueRangeScalar(const double *values, int begin, int end, double &lower, double &upper)
+{
+  for (int i=begin; i<end; ++i)
   {
-    QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
-    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
-    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
-    while (it != end)
+    const double value = values[i];
+    if (std::isfinite(value)) // also false for NaN
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
-      {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
-      {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(it->key)+reversedRound));
-        if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
-      }
-      ++it;
+      if (value < lower)
+        lower = value;
+      if (value > upper)
+        upper = value;
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-    {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-    } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-    
-  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
-  {
-    lineData->resize(dataCount);
-    std::copy(begin, end, lineData->begin());
   }
 }
 
+#ifdef QCP_SIMD_X86
 /*! \internal
 
-  Returns via \a scatterData the data points that need to be visualized for this graph when
-  plotting scatter points, taking into consideration the currently visible axis ranges and, if \ref
-  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
-  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
-  getDataSegments).
-
-  This method is used by \ref getScatters to retrieve the basic working set of data.
+  Folds the lane results \a laneMin and \a laneMax of a vectorized scan into \a minValue and \a
+  maxValue like the scalar loop would. Returns false and leaves both unchanged if the result could
+  depend on the order of the data points, the scan must then be repeated in order.
 
-  \see getOptimizedLineData
+  MINPD/MAXPD return the second operand unless the first is strictly smaller/larger, which is the
+  scalar loop's comparison, so each lane ends up with the first extreme of its points. Across lanes
+  only +0.0 and -0.0 compare equal but differ in their bits, so an extreme of zero is ambiguous.
 */
-void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const
+bool qcpFoldLanes(double &minValue, double &maxValue, const double *laneMin, const double *laneMax, int lanes)
 {
-  if (!scatterData) return;
-  QCPAxis *keyAxis = mKeyAxis.data();
-  QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  
-  const int scatterModulo = mScatterSkip+1;
-  const bool doScatterSkip = mScatterSkip > 0;
-  int beginIndex = int(begin-mDataContainer->constBegin());
-  int endIndex = int(end-mDataContainer->constBegin());
-  while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
+  double foldedMin = minValue;
+  double foldedMax = maxValue;
+  for (int i=0; i<lanes; ++i)
   {
-    ++beginIndex;
-    ++begin;
+    if (laneMin[i] < foldedMin)
+      foldedMin = laneMin[i];
+    if (laneMax[i] > foldedMax)
+      foldedMax = laneMax[i];
   }
-  if (begin == end) return;
-  int dataCount = int(end-begin);
-  int maxCount = (std::numeric_limits<int>::max)();
-  if (mAdaptiveSampling)
+  if (foldedMin == 0 || foldedMax == 0)
+    return false;
+  minValue = foldedMin;
+  maxValue = foldedMax;
+  return true;
+}
+
+/*! \internal
+
+  Finishes a vectorized interval scan that consumed the points from \a first to \a it with the
+  lane results \a laneMin and \a laneMax: the lanes are folded (see \ref qcpFoldLanes), and the
+  rest of the interval is scanned one point at a time.
+*/
+const QCPGraphData *qcpFinishInterval(const QCPGraphData *first, const QCPGraphData *it, const QCPGraphData *end, double keyLimit, double &minValue, double &maxValue, const double *laneMin, const double *laneMax, int lanes)
+{
+  if (it != first && !qcpFoldLanes(minValue, maxValue, laneMin, laneMax, lanes))
+    it = first;
+  return qcpScanIntervalScalar(it, end, keyLimit, minValue, maxValue);
+}
+
+const QCPGraphData *qcpScanIntervalSse2(const QCPGraphData *it, const QCPGraphData *end, double keyLimit, double &minValue, double &maxValue)
+{
+  const QCPGraphData *first = it;
+  const __m128d limit = _mm_set1_pd(keyLimit);
+  __m128d vMin = _mm_set1_pd(minValue);
+  __m128d vMax = _mm_set1_pd(maxValue);
+  // two points per step while all of them are in the interval, the scalar tail finds its end
+  while (end-it >= 2)
   {
-    int keyPixelSpan = int(qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key)));
-    maxCount = 2*keyPixelSpan+2;
+    const __m128d a = _mm_loadu_pd(&it[0].key); // key0 value0
+    const __m128d b = _mm_loadu_pd(&it[1].key); // key1 value1
+    if (_mm_movemask_pd(_mm_cmplt_pd(_mm_unpacklo_pd(a, b), limit)) != 0x3)
+      break;
+    const __m128d values = _mm_unpackhi_pd(a, b);
+    vMin = _mm_min_pd(values, vMin);
+    vMax = _mm_max_pd(values, vMax);
+    it += 2;
   }
-  
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  double laneMin[2], laneMax[2];
+  _mm_storeu_pd(laneMin, vMin);
+  _mm_storeu_pd(laneMax, vMax);
+  return qcpFinishInterval(first, it, end, keyLimit, minValue, maxValue, laneMin, laneMax, 2);
+}
+
+QCP_TARGET_AVX const QCPGraphData *qcpScanIntervalAvx(const QCPGraphData *it, const QCPGraphData *end, double keyLimit, double &minValue, double &maxValue)
+{
+  const QCPGraphData *first = it;
+  const __m256d limit = _mm256_set1_pd(keyLimit);
+  __m256d vMin = _mm256_set1_pd(minValue);
+  __m256d vMax = _mm256_set1_pd(maxValue);
+  // four points per step, in the lane order 0 2 1 3 which doesn't matter for the extremes
+  while (end-it >= 4)
+  {
+    const __m256d a = _mm256_loadu_pd(&it[0].key); // key0 value0 key1 value1
+    const __m256d b = _mm256_loadu_pd(&it[2].key); // key2 value2 key3 value3
+    if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_unpacklo_pd(a, b), limit, _CMP_LT_OQ)) != 0xF)
+      break;
+    const __m256d values = _mm256_unpackhi_pd(a, b);
+    vMin = _mm256_min_pd(values, vMin);
+    vMax = _mm256_max_pd(values, vMax);
+    it += 4;
+  }
+  double laneMin[4], laneMax[4];
+  _mm256_storeu_pd(laneMin, vMin);
+  _mm256_storeu_pd(laneMax, vMax);
+  _mm256_zeroupper();
+  return qcpFinishInterval(first, it, end, keyLimit, minValue, maxValue, laneMin, laneMax, 4);
+}
+
+int qcpScanSoaIntervalSse2(const double *keys, const double *values, int it, int end, double keyLimit, double &minValue, double &maxValue)
+{
+  const int first = it;
+  const __m128d limit = _mm_set1_pd(keyLimit);
+  __m128d vMin = _mm_set1_pd(minValue);
+  __m128d vMax = _mm_set1_pd(maxValue);
+  // the keys and values are already in lanes, no shuffling like for QCPGraphData
+  while (end-it >= 2)
+  {
+    if (_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(keys+it), limit)) != 0x3)
+      break;
+    const __m128d v = _mm_loadu_pd(values+it);
+    vMin = _mm_min_pd(v, vMin);
+    vMax = _mm_max_pd(v, vMax);
+    it += 2;
+  }
+  double laneMin[2], laneMax[2];
+  _mm_storeu_pd(laneMin, vMin);
+  _mm_storeu_pd(laneMax, vMax);
+  if (it != first && !qcpFoldLanes(minValue, maxValue, laneMin, laneMax, 2))
+    it = first;
+  return qcpScanSoaIntervalScalar(keys, values, it, end, keyLimit, minValue, maxValue);
+}
+
+QCP_TARGET_AVX int qcpScanSoaIntervalAvx(const double *keys, const double *values, int it, int end, double keyLimit, double &minValue, double &maxValue)
+{
+  const int first = it;
+  const __m256d limit = _mm256_set1_pd(keyLimit);
+  __m256d vMin = _mm256_set1_pd(minValue);
+  __m256d vMax = _mm256_set1_pd(maxValue);
+  while (end-it >= 4)
+  {
+    if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(keys+it), limit, _CMP_LT_OQ)) != 0xF)
+      break;
+    const __m256d v = _mm256_loadu_pd(values+it);
+    vMin = _mm256_min_pd(v, vMin);
+    vMax = _mm256_max_pd(v, vMax);
+    it += 4;
+  }
+  double laneMin[4], laneMax[4];
+  _mm256_storeu_pd(laneMin, vMin);
+  _mm256_storeu_pd(laneMax, vMax);
+  _mm256_zeroupper();
+  if (it != first && !qcpFoldLanes(minValue, maxValue, laneMin, laneMax, 4))
+    it = first;
+  return qcpScanSoaIntervalScalar(keys, values, it, end, keyLimit, minValue, maxValue);
+}
+
+void qcpScanValueRangeSse2(const double *values, int begin, int end, double &lower, double &upper)
+{
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d posInf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+  const __m128d negInf = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+  __m128d vMin = _mm_set1_pd(lower);
+  __m128d vMax = _mm_set1_pd(upper);
+  int i = begin;
+  for (; end-i >= 2; i += 2)
+  {
+    // non-finite values are replaced by the infinity that can't change the respective bound:
+    const __m128d v = _mm_loadu_pd(values+i);
+    const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(v, v), zero); // Inf-Inf and NaN-NaN are NaN
+    vMin = _mm_min_pd(_mm_or_pd(_mm_and_pd(finite, v), _mm_andnot_pd(finite, posInf)), vMin);
+    vMax = _mm_max_pd(_mm_or_pd(_mm_and_pd(finite, v), _mm_andnot_pd(finite, negInf)), vMax);
+  }
+  double laneMin[2], laneMax[2];
+  _mm_storeu_pd(laneMin, vMin);
+  _mm_storeu_pd(laneMax, vMax);
+  if (i != begin && !qcpFoldLanes(lower, upper, laneMin, laneMax, 2))
+    i = begin;
+  qcpScanValueRangeScalar(values, i, end, lower, upper);
+}
+
+QCP_TARGET_AVX void qcpScanValueRangeAvx(const double *values, int begin, int end, double &lower, double &upper)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d posInf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+  const __m256d negInf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+  __m256d vMin = _mm256_set1_pd(lower);
+  __m256d vMax = _mm256_set1_pd(upper);
+  int i = begin;
+  for (; end-i >= 4; i += 4)
+  {
+    const __m256d v = _mm256_loadu_pd(values+i);
+    const __m256d finite = _mm256_cmp_pd(_mm256_sub_pd(v, v), zero, _CMP_EQ_OQ);
+    vMin = _mm256_min_pd(_mm256_blendv_pd(posInf, v, finite), vMin);
+    vMax = _mm256_max_pd(_mm256_blendv_pd(negInf, v, finite), vMax);
+  }
+  double laneMin[4], laneMax[4];
+  _mm256_storeu_pd(laneMin, vMin);
+  _mm256_storeu_pd(laneMax, vMax);
+  _mm256_zeroupper();
+  if (i != begin && !qcpFoldLanes(lower, upper, laneMin, laneMax, 4))
+    i = begin;
+  qcpScanValueRangeScalar(values, i, end, lower, upper);
+}
+
+bool qcpCpuHasAvx()
+{
+#  if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+  return osSavesYmm && (info[2] & (1 << 28));
+#  else
+  return __builtin_cpu_supports("avx");
+#  endif
+}
+#endif // QCP_SIMD_X86
+
+QCP::SimdLevel qcpSupportedSimdLevel()
+{
+#ifdef QCP_SIMD_X86
+  static const QCP::SimdLevel level = qcpCpuHasAvx() ? QCP::slAvx : QCP::slSse2;
+  return level;
+#else
+  return QCP::slScalar;
+#endif
+}
+
+QCP::SimdLevel qcpSimdLevel = qcpSupportedSimdLevel();
+
+QCPIntervalScan qcpIntervalScan()
+{
+  switch (qcpSimdLevel)
+  {
+#ifdef QCP_SIMD_X86
+    case QCP::slAvx: return qcpScanIntervalAvx;
+    case QCP::slSse2: return qcpScanIntervalSse2;
+#endif
+    default: return qcpScanIntervalScalar;
+  }
+}
+
+QCPSoaIntervalScan qcpSoaIntervalScan()
+{
+  switch (qcpSimdLevel)
+  {
+#ifdef QCP_SIMD_X86
+    case QCP::slAvx: return qcpScanSoaIntervalAvx;
+    case QCP::slSse2: return qcpScanSoaIntervalSse2;
+#endif
+    default: return qcpScanSoaIntervalScalar;
+  }
+}
+
+QCPValueRangeScan qcpValueRangeScan()
+{
+  switch (qcpSimdLevel)
+  {
+#ifdef QCP_SIMD_X86
+    case QCP::slAvx: return qcpScanValueRangeAvx;
+    case QCP::slSse2: return qcpScanValueRangeSse2;
+#endif
+    default: return qcpScanValueRangeScalar;
+  }
+}
+
+/*! \internal
+
+  The data points of a graph's own \ref QCPGraphDataContainer, for \ref qcpOptimizedLineData.
+*/
+class QCPContainerPoints
+{
+public:
+  explicit QCPContainerPoints(const QCPGraphData *data) : mData(data), mScan(qcpIntervalScan()) {}
+  double key(int index) const { return mData[index].key; }
+  double value(int index) const { return mData[index].value; }
+  int scan(int it, int end, double keyLimit, double &minValue, double &maxValue) const { return int(mScan(mData+it, mData+end, keyLimit, minValue, maxValue)-mData); }
+  void copy(int begin, int end, QCPGraphData *output) const { std::copy(mData+begin, mData+end, output); }
+  
+private:
+  const QCPGraphData *mData;
+  QCPIntervalScan mScan;
+};
+
+/*! \internal
+
+  The data points of a \ref QCPGraphDataSource, for \ref qcpOptimizedLineData.
+*/
+class QCPSourcePoints
+{
+public:
+  explicit QCPSourcePoints(const QCPGraphDataSource *source) : mSource(source) {}
+  double key(int index) const { return mSource->keyAt(index); }
+  double value(int index) const { return mSource->valueAt(index); }
+  int scan(int it, int end, double keyLimit, double &minValue, double &maxValue) const { return mSource->scanInterval(it, end, keyLimit, minValue, maxValue); }
+  void copy(int begin, int end, QCPGraphData *output) const
+  {
+    for (int i=begin; i<end; ++i)
+      *output++ = QCPGraphData(mSource->keyAt(i), mSource->valueAt(i));
+  }
+  
+private:
+  const QCPGraphDataSource *mSource;
+};
+
+/*! \internal
+
+  The algorithm of \ref QCPGraph::getOptimizedLineData for the data points \a begin to \a end of \a
+  points, which is a \ref QCPContainerPoints or a \ref QCPSourcePoints. The pixel intervals are
+  scanned by the points' scan method, the points are otherwise only accessed at the borders of the
+  intervals.
+*/
+template <class Points>
+void qcpOptimizedLineData(QVector<QCPGraphData> *lineData, const Points &points, int begin, int end, const QCPAxis *keyAxis, bool adaptiveSampling)
+{
+  int dataCount = end-begin;
+  int maxCount = (std::numeric_limits<int>::max)();
+  if (adaptiveSampling)
+  {
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(points.key(begin))-keyAxis->coordToPixel(points.key(end-1)));
+    if (2*keyPixelSpan+2 < static_cast<double>((std::numeric_limits<int>::max)()))
+      maxCount = int(2*keyPixelSpan+2);
+  }
+  
+  if (adaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    int it = begin;
+    double minValue = points.value(it);
+    double maxValue = points.value(it);
+    int currentIntervalFirstPoint = it;
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
+    double currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(points.key(begin))+reversedRound));
+    double lastIntervalEndKey = currentIntervalStartKey;
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    int intervalDataCount = 1;
+    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
+    while (it != end)
+    {
+      // skip the data points still within the same pixel and expand the value span of this cluster if necessary:
+      const int intervalEnd = points.scan(it, end, currentIntervalStartKey+keyEpsilon, minValue, maxValue);
+      intervalDataCount += intervalEnd-it;
+      it = intervalEnd;
+      if (it != end) // new pixel interval started
+      {
+        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+        {
+          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, points.value(currentIntervalFirstPoint)));
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+          if (points.key(it) > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
+            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, points.value(it-1)));
+        } else
+          lineData->append(QCPGraphData(points.key(currentIntervalFirstPoint), points.value(currentIntervalFirstPoint)));
+        lastIntervalEndKey = points.key(it-1);
+        minValue = points.value(it);
+        maxValue = points.value(it);
+        currentIntervalFirstPoint = it;
+        currentIntervalStartKey = keyAxis->pixelToCoord(int(keyAxis->coordToPixel(points.key(it))+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+        intervalDataCount = 1;
+        ++it;
+      }
+    }
+    // handle last interval:
+    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
+    {
+      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
+        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, points.value(currentIntervalFirstPoint)));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
+      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
+    } else
+      lineData->append(QCPGraphData(points.key(currentIntervalFirstPoint), points.value(currentIntervalFirstPoint)));
+    
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
+  {
+    lineData->resize(dataCount);
+    points.copy(begin, end, lineData->data());
+  }
+}
+
+} // anonymous namespace
+
+/*!
+  Returns the instruction set that the adaptive sampling of \ref QCPGraph currently uses. By
+  default, this is the best one the CPU supports.
+
+  \see setSimdLevel
+*/
+QCP::SimdLevel QCP::simdLevel()
+{
+  return qcpSimdLevel;
+}
+
+/*!
+  Sets the instruction set that the adaptive sampling of \ref QCPGraph uses, e.g. to compare them.
+  Levels the CPU doesn't support fall back to the best one it does. This is a global setting that
+  isn't synchronized, call it before plotting.
+
+  \see simdLevel
+*/
+void QCP::setSimdLevel(QCP::SimdLevel level)
+{
+  qcpSimdLevel = qMin(level, qcpSupportedSimdLevel());
+}
+
+/*! \internal
+
+  Returns via \a lineData the data points that need to be visualized for this graph when plotting
+  graph lines, taking into consideration the currently visible axis ranges and, if \ref
+  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
+  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
+  getDataSegments).
+
+  This method is used by \ref getLines to retrieve the basic working set of data.
+
+  \see getOptimizedScatterData
+*/
+void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
+{
+  if (!lineData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (begin == end) return;
+  
+  // the data points are contiguous, the algorithm works on their indices:
+  qcpOptimizedLineData(lineData, QCPContainerPoints(&*begin), 0, int(end-begin), keyAxis, mAdaptiveSampling);
+}
+
+/*! \internal
+
+  Returns via \a scatterData the data points that need to be visualized for this graph when
+  plotting scatter points, taking into consideration the currently visible axis ranges and, if \ref
+  setAdaptiveSampling is enabled, local point densities. The considered data can be restricted
+  further by \a begin and \a end, e.g. to only plot a certain segment of the data (see \ref
+  getDataSegments).
+
+  This method is used by \ref getScatters to retrieve the basic working set of data.
+
+  \see getOptimizedLineData
+*/
+void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const
+{
+  if (!scatterData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  const int scatterModulo = mScatterSkip+1;
+  const bool doScatterSkip = mScatterSkip > 0;
+  int beginIndex = int(begin-mDataContainer->constBegin());
+  int endIndex = int(end-mDataContainer->constBegin());
+  while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
+  {
+    ++beginIndex;
+    ++begin;
+  }
+  if (begin == end) return;
+  int dataCount = int(end-begin);
+  int maxCount = (std::numeric_limits<int>::max)();
+  if (mAdaptiveSampling)
+  {
+    int keyPixelSpan = int(qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key)));
+    maxCount = 2*keyPixelSpan+2;
+  }
+  
+  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
     double valueMaxRange = valueAxis->range().upper;
     double valueMinRange = valueAxis->range().lower;
@@ -21985,6 +22597,63 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
   }
 }
 
+/*! \overload
+
+  Outputs the currently visible data range of the data source (see \ref setDataSource) as the
+  indices \a begin and \a end.
+*/
+void QCPGraph::getVisibleDataBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const
+{
+  begin = end = 0;
+  if (rangeRestriction.isEmpty() || !mDataSource)
+    return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  // get visible data range and limit it to rangeRestriction:
+  QCPDataRange visible(mDataSource->findBegin(keyAxis->range().lower), mDataSource->findEnd(keyAxis->range().upper));
+  visible = visible.bounded(rangeRestriction.bounded(QCPDataRange(0, mDataSource->size())));
+  begin = visible.begin();
+  end = visible.end();
+}
+
+/*! \internal
+
+  The \ref getOptimizedLineData of the data source (see \ref setDataSource), for the data points
+  with the indices \a begin to \a end. The same adaptive sampling runs on the source's \ref
+  QCPGraphDataSource::scanInterval.
+*/
+void QCPGraph::getSourceLineData(QVector<QCPGraphData> *lineData, int begin, int end) const
+{
+  if (!lineData || !mDataSource) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (begin == end) return;
+  
+  qcpOptimizedLineData(lineData, QCPSourcePoints(mDataSource.data()), begin, end, keyAxis, mAdaptiveSampling);
+}
+
+/*! \internal
+
+  Returns via \a scatterData the data points of the data source (see \ref setDataSource) with the
+  indices \a begin to \a end that are drawn as scatters. Unlike \ref getOptimizedScatterData,
+  this only skips points according to \ref setScatterSkip.
+*/
+void QCPGraph::getSourceScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const
+{
+  if (!scatterData || !mDataSource) return;
+  
+  const int scatterModulo = mScatterSkip+1;
+  int it = begin;
+  if (it % scatterModulo != 0) // advance to first non-skipped scatter
+    it += scatterModulo-it%scatterModulo;
+  if (it < end)
+    scatterData->reserve((end-it+scatterModulo-1)/scatterModulo);
+  for (; it < end; it += scatterModulo)
+    scatterData->append(QCPGraphData(mDataSource->keyAt(it), mDataSource->valueAt(it)));
+}
+
 /*!  \internal
   
   This method goes through the passed points in \a lineData and returns a list of the segments
@@ -22467,6 +23136,57 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   return qSqrt(minDistSqr);
 }
 
+/*! \internal \overload
+
+  The \ref pointDistance of the data source (see \ref setDataSource), the index of the closest
+  data point is returned in \a closestIndex.
+*/
+double QCPGraph::pointDistance(const QPointF &pixelPoint, int &closestIndex) const
+{
+  closestIndex = mDataSource ? mDataSource->size() : 0;
+  if (!mDataSource || mDataSource->isEmpty())
+    return -1.0;
+  if (mLineStyle == lsNone && mScatterStyle.isNone())
+    return -1.0;
+  
+  // calculate minimum distances to graph data points and find closestIndex:
+  double minDistSqr = (std::numeric_limits<double>::max)();
+  // determine which key range comes into question, taking selection tolerance around pos into account:
+  double posKeyMin, posKeyMax, dummy;
+  pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
+  pixelsToCoords(pixelPoint+QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMax, dummy);
+  if (posKeyMin > posKeyMax)
+    qSwap(posKeyMin, posKeyMax);
+  // iterate over found data points and then choose the one with the shortest distance to pos:
+  const int end = mDataSource->findEnd(posKeyMax, true);
+  for (int i=mDataSource->findBegin(posKeyMin, true); i<end; ++i)
+  {
+    const double currentDistSqr = QCPVector2D(coordsToPixels(mDataSource->keyAt(i), mDataSource->valueAt(i))-pixelPoint).lengthSquared();
+    if (currentDistSqr < minDistSqr)
+    {
+      minDistSqr = currentDistSqr;
+      closestIndex = i;
+    }
+  }
+  
+  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
+  if (mLineStyle != lsNone)
+  {
+    QVector<QPointF> lineData;
+    getLines(&lineData, QCPDataRange(0, dataCount()));
+    QCPVector2D p(pixelPoint);
+    const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
+    for (int i=0; i<lineData.size()-1; i+=step)
+    {
+      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  }
+  
+  return qSqrt(minDistSqr);
+}
+
 /*! \internal
   
   Finds the highest index of \a data, whose points y value is just below \a y. Assumes y values in
@@ -22489,6 +23209,446 @@ int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
   }
   return -1;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphDataSource
+  \brief Abstract interface to the data points of a \ref QCPGraph
+
+  A graph normally draws the data of its own \ref QCPGraphDataContainer. After \ref
+  QCPGraph::setDataSource it draws the data points of a QCPGraphDataSource instead, such as a \ref
+  QCPGraphSpanDataSource. The data points are accessed by index and must be sorted by key.
+
+  Subclasses implement \ref size, \ref keyAt and \ref valueAt. The other methods have generic
+  implementations based on those three, which subclasses may reimplement with faster ones for their
+  storage: \ref findBegin and \ref findEnd search keys, \ref keyRange and \ref valueRange are used
+  for axis rescaling, and \ref scanInterval is the inner loop of the graph's adaptive sampling.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn bool QCPGraphDataSource::isEmpty() const
+
+  Returns whether this source has no data points.
+*/
+
+/* end documentation of inline functions */
+
+/* start documentation of pure virtual functions */
+
+/*! \fn virtual int QCPGraphDataSource::size() const = 0
+
+  Returns the number of data points.
+*/
+
+/*! \fn virtual double QCPGraphDataSource::keyAt(int index) const = 0
+
+  Returns the key of the data point at \a index, which is between 0 and \ref size - 1.
+*/
+
+/*! \fn virtual double QCPGraphDataSource::valueAt(int index) const = 0
+
+  Returns the value of the data point at \a index, which is between 0 and \ref size - 1.
+*/
+
+/* end documentation of pure virtual functions */
+
+QCPGraphDataSource::~QCPGraphDataSource()
+{
+}
+
+/*!
+  Returns the index of the data point with a key that is equal to, just below, or just above \a
+  key, like \ref QCPDataContainer::findBegin. If \a expandedRange is true, the data point just below
+  \a key will be considered, otherwise the one just above.
+
+  The default implementation is a binary search with \ref keyAt.
+*/
+int QCPGraphDataSource::findBegin(double key, bool expandedRange) const
+{
+  int lower = 0;
+  int upper = size();
+  while (lower < upper) // first index with a key not smaller than key
+  {
+    const int middle = lower+(upper-lower)/2;
+    if (keyAt(middle) < key)
+      lower = middle+1;
+    else
+      upper = middle;
+  }
+  if (expandedRange && lower > 0)
+    --lower;
+  return lower;
+}
+
+/*!
+  Returns the index after the data point with a key that is equal to, just above, or just below \a
+  key, like \ref QCPDataContainer::findEnd. If \a expandedRange is true, the data point just above
+  \a key will be considered, otherwise the one just below.
+
+  The default implementation is a binary search with \ref keyAt.
+*/
+int QCPGraphDataSource::findEnd(double key, bool expandedRange) const
+{
+  int lower = 0;
+  int upper = size();
+  while (lower < upper) // first index with a key greater than key
+  {
+    const int middle = lower+(upper-lower)/2;
+    if (key < keyAt(middle))
+      upper = middle;
+    else
+      lower = middle+1;
+  }
+  if (expandedRange && lower < size())
+    ++lower;
+  return lower;
+}
+
+/*!
+  Returns the range of the keys of the data points with a non-NaN value, like \ref
+  QCPDataContainer::keyRange. The output parameter \a foundRange indicates whether a sensible range
+  was found. \a signDomain selects the sign of the keys that are considered.
+*/
+QCPRange QCPGraphDataSource::keyRange(bool &foundRange, QCP::SignDomain signDomain) const
+{
+  const int n = size();
+  QCPRange range;
+  bool haveLower = false;
+  bool haveUpper = false;
+  if (signDomain == QCP::sdBoth) // the keys are sorted, so the range is spanned by the first and last point with a non-NaN value
+  {
+    for (int i=0; i<n; ++i)
+    {
+      if (!qIsNaN(valueAt(i)))
+      {
+        range.lower = keyAt(i);
+        haveLower = true;
+        break;
+      }
+    }
+    for (int i=n-1; i>=0; --i)
+    {
+      if (!qIsNaN(valueAt(i)))
+      {
+        range.upper = keyAt(i);
+        haveUpper = true;
+        break;
+      }
+    }
+  } else
+  {
+    for (int i=0; i<n; ++i)
+    {
+      const double current = keyAt(i);
+      if (qIsNaN(valueAt(i)) || (signDomain == QCP::sdNegative && !(current < 0)) || (signDomain == QCP::sdPositive && !(current > 0)))
+        continue;
+      if (current < range.lower || !haveLower)
+      {
+        range.lower = current;
+        haveLower = true;
+      }
+      if (current > range.upper || !haveUpper)
+      {
+        range.upper = current;
+        haveUpper = true;
+      }
+    }
+  }
+  foundRange = haveLower && haveUpper;
+  return range;
+}
+
+/*!
+  Returns the range of the values of the data points in the key range \a inKeyRange, like \ref
+  QCPDataContainer::valueRange. Inf, -Inf and NaN values are ignored. If \a inKeyRange is equal to
+  <tt>QCPRange()</tt>, all data points are considered. The output parameter \a foundRange indicates
+  whether a sensible range was found. \a signDomain selects the sign of the values that are
+  considered.
+*/
+QCPRange QCPGraphDataSource::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  int begin = 0;
+  int end = size();
+  if (inKeyRange != QCPRange())
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  QCPRange range;
+  bool haveLower = false;
+  bool haveUpper = false;
+  for (int i=begin; i<end; ++i)
+  {
+    const double current = valueAt(i);
+    if (!std::isfinite(current) || (signDomain == QCP::sdNegative && !(current < 0)) || (signDomain == QCP::sdPositive && !(current > 0)))
+      continue;
+    if (current < range.lower || !haveLower)
+    {
+      range.lower = current;
+      haveLower = true;
+    }
+    if (current > range.upper || !haveUpper)
+    {
+      range.upper = current;
+      haveUpper = true;
+    }
+  }
+  foundRange = haveLower && haveUpper;
+  return range;
+}
+
+/*!
+  Advances from the index \a begin over the data points up to \a end whose key is smaller than \a
+  keyLimit, and expands \a minValue and \a maxValue by their values. Returns the index of the first
+  data point beyond them.
+
+  This is the inner loop of the adaptive sampling of \ref QCPGraph, called once for each pixel
+  interval. A value only replaces \a minValue or \a maxValue if it is strictly smaller or larger,
+  so NaN values are skipped and, of equal values, the first one is kept.
+*/
+int QCPGraphDataSource::scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const
+{
+  int it = begin;
+  while (it != end && keyAt(it) < keyLimit)
+  {
+    const double value = valueAt(it);
+    if (value < minValue)
+      minValue = value;
+    else if (value > maxValue)
+      maxValue = value;
+    ++it;
+  }
+  return it;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphSpanDataSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphSpanDataSource
+  \brief A graph data source over key and value arrays that it doesn't own
+
+  Lets a \ref QCPGraph draw data that already lives in arrays elsewhere in the application, without
+  copying it into a data container. The arrays hold the keys and values separately and are either
+  one contiguous span (\ref setData) or a ring buffer (\ref setRing), whose data points run from
+  the index \ref first to the end of the buffer and continue at its start.
+
+  The source only keeps the pointers. The arrays must outlive it, or at least the graphs that draw
+  it, and must not change while a graph draws. When the owner appends, removes or moves data, it
+  updates the source with \ref setData or \ref setRing before the next replot, e.g. in a slot of
+  \ref QCustomPlot::beforeReplot. The keys must be sorted in the order of the data points.
+
+  A graph draws the source after \ref QCPGraph::setDataSource. Several graphs may share one source,
+  e.g. to show the same channel in different plots, and are all up to date after one update.
+
+  Owners that track the value range of their data as it changes, e.g. a sliding window, can pass
+  it with \ref setValueRange after each update. Rescaling then doesn't scan the values.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn const double *QCPGraphSpanDataSource::keys() const
+
+  Returns the key array as passed to \ref setData or \ref setRing.
+*/
+
+/*! \fn const double *QCPGraphSpanDataSource::values() const
+
+  Returns the value array as passed to \ref setData or \ref setRing.
+*/
+
+/*! \fn int QCPGraphSpanDataSource::capacity() const
+
+  Returns the number of elements of the ring buffer, or the size of a contiguous span.
+*/
+
+/*! \fn int QCPGraphSpanDataSource::first() const
+
+  Returns the array index of the first data point, which is 0 for a contiguous span.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty source.
+*/
+QCPGraphSpanDataSource::QCPGraphSpanDataSource() :
+  mKeys(nullptr),
+  mValues(nullptr),
+  mCapacity(0),
+  mFirst(0),
+  mSize(0),
+  mHasValueRange(false),
+  mValueRangeFound(false)
+{
+}
+
+/*!
+  Makes the source refer to the \a size data points in the contiguous arrays \a keys and \a
+  values.
+
+  \see setRing
+*/
+void QCPGraphSpanDataSource::setData(const double *keys, const double *values, int size)
+{
+  setRing(keys, values, size, 0, size);
+}
+
+/*!
+  Makes the source refer to the \a size data points of the ring buffers \a keys and \a values,
+  which have \a capacity elements each. The data points start at the index \a first and wrap around
+  to index 0 at the end of the buffers.
+
+  \see setData
+*/
+void QCPGraphSpanDataSource::setRing(const double *keys, const double *values, int capacity, int first, int size)
+{
+  if (size < 0 || size > capacity || first < 0 || (first >= capacity && capacity > 0) || (size > 0 && (!keys || !values)))
+  {
+    qDebug() << Q_FUNC_INFO << "invalid ring buffer, capacity" << capacity << "first" << first << "size" << size;
+    return;
+  }
+  mKeys = keys;
+  mValues = values;
+  mCapacity = capacity;
+  mFirst = first;
+  mSize = size;
+  mHasValueRange = false;
+}
+
+/*!
+  Sets the value range of all data points of the source, as the owner tracks it, so \ref
+  valueRange doesn't have to scan the values. \a foundRange is false if there is no finite value,
+  \a range is then ignored.
+
+  The range must be what \ref valueRange would find, i.e. of the finite values, and of equal values
+  the first one. It holds until the next \ref setData, \ref setRing or \ref clear, so set it again
+  after each of them.
+*/
+void QCPGraphSpanDataSource::setValueRange(bool foundRange, const QCPRange &range)
+{
+  mHasValueRange = true;
+  mValueRangeFound = foundRange;
+  mValueRange = foundRange ? range : QCPRange();
+}
+
+/*!
+  Makes the source empty. It doesn't refer to any arrays afterwards.
+*/
+void QCPGraphSpanDataSource::clear()
+{
+  mKeys = nullptr;
+  mValues = nullptr;
+  mCapacity = 0;
+  mFirst = 0;
+  mSize = 0;
+  mHasValueRange = false;
+}
+
+/* inherits documentation from base class */
+int QCPGraphSpanDataSource::findBegin(double key, bool expandedRange) const
+{
+  int index = lowerBound(key);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/* inherits documentation from base class */
+int QCPGraphSpanDataSource::findEnd(double key, bool expandedRange) const
+{
+  int index = upperBound(key);
+  if (expandedRange && index < mSize)
+    ++index;
+  return index;
+}
+
+/*!
+  \copydoc QCPGraphDataSource::valueRange
+
+  For both sign domains, this returns the range passed to \ref setValueRange if the key range
+  covers all data points, and otherwise scans the value arrays of the key range directly, several
+  values per instruction.
+*/
+QCPRange QCPGraphSpanDataSource::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  if (signDomain != QCP::sdBoth) // only log axes ask for one sign domain
+    return QCPGraphDataSource::valueRange(foundRange, signDomain, inKeyRange);
+  if (mHasValueRange && (inKeyRange == QCPRange() || mSize == 0 ||
+                         (inKeyRange.lower <= keyAt(0) && inKeyRange.upper >= keyAt(mSize-1))))
+  {
+    foundRange = mValueRangeFound;
+    return mValueRange;
+  }
+  
+  int begin = 0;
+  int end = mSize;
+  if (inKeyRange != QCPRange())
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -std::numeric_limits<double>::infinity();
+  const int head = headSize();
+  if (begin < head)
+    qcpValueRangeScan()(mValues+mFirst, begin, qMin(end, head), lower, upper);
+  if (end > head)
+    qcpValueRangeScan()(mValues, qMax(begin, head)-head, end-head, lower, upper);
+  foundRange = lower <= upper;
+  return foundRange ? QCPRange(lower, upper) : QCPRange();
+}
+
+/* inherits documentation from base class */
+int QCPGraphSpanDataSource::scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const
+{
+  const int head = headSize();
+  int it = begin;
+  if (it < head)
+  {
+    const int headEnd = qMin(end, head);
+    it = qcpSoaIntervalScan()(mKeys+mFirst, mValues+mFirst, it, headEnd, keyLimit, minValue, maxValue);
+    if (it < headEnd) // reached the key limit before the wrap
+      return it;
+  }
+  if (it < end)
+    it = head+qcpSoaIntervalScan()(mKeys, mValues, it-head, end-head, keyLimit, minValue, maxValue);
+  return it;
+}
+
+/*! \internal
+
+  Returns the index of the first data point with a key not smaller than \a key. Searches the part
+  of a ring buffer before the wrap or the part after it, each a contiguous array.
+*/
+int QCPGraphSpanDataSource::lowerBound(double key) const
+{
+  const int head = headSize();
+  const double *keys = mKeys+mFirst;
+  if (head == mSize || !(keys[head-1] < key))
+    return int(std::lower_bound(keys, keys+head, key)-keys);
+  return head+int(std::lower_bound(mKeys, mKeys+(mSize-head), key)-mKeys);
+}
+
+/*! \internal
+
+  Returns the index of the first data point with a key greater than \a key, see \ref lowerBound.
+*/
+int QCPGraphSpanDataSource::upperBound(double key) const
+{
+  const int head = headSize();
+  const double *keys = mKeys+mFirst;
+  if (head == mSize || key < keys[head-1])
+    return int(std::upper_bound(keys, keys+head, key)-keys);
+  return head+int(std::upper_bound(mKeys, mKeys+(mSize-head), key)-mKeys);
+}
+
+
 /* end of 'src/plottables/plottable-graph.cpp' */
 
 
@@ -387,6 +387,21 @@ inline int getMarginValue(const QMargins &margins, QCP::MarginSide side)
   return 0;
 }
 
+/*!
+  Defines the instruction set that the adaptive sampling of \ref QCPGraph uses to reduce the data
+  points of one pixel to their minimum and maximum (see \ref QCPGraph::setAdaptiveSampling), and
+  that \ref QCPGraphSpanDataSource uses for its value range. All levels produce identical output.
+
+  \see setSimdLevel
+*/
+enum SimdLevel { slScalar ///< One data point at a time
+                 ,slSse2  ///< Two data points per instruction (x86-64)
+                 ,slAvx   ///< Four data points per instruction (x86-64 with AVX)
+               };
+
+QCP_LIB_DECL SimdLevel simdLevel();
+QCP_LIB_DECL void setSimdLevel(SimdLevel level);
+
 // for newer Qt versions we have to declare the enums/flags as metatypes inside the namespace using Q_ENUM_NS/Q_FLAG_NS:
 // if you change anything here, don't forget to change it for older Qt versions below, too,
 // and at the start of the namespace in the fake moc-run class
@@ -5491,6 +5506,71 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphDataSource
+{
+public:
+  virtual ~QCPGraphDataSource();
+
+  // getters:
+  bool isEmpty() const { return size() == 0; }
+
+  // introduced virtual methods:
+  virtual int size() const = 0;
+  virtual double keyAt(int index) const = 0;
+  virtual double valueAt(int index) const = 0;
+  virtual int findBegin(double key, bool expandedRange=true) const;
+  virtual int findEnd(double key, bool expandedRange=true) const;
+  virtual QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth) const;
+  virtual QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const;
+  virtual int scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const;
+};
+
+class QCP_LIB_DECL QCPGraphSpanDataSource : public QCPGraphDataSource
+{
+public:
+  QCPGraphSpanDataSource();
+  
+  // getters:
+  const double *keys() const { return mKeys; }
+  const double *values() const { return mValues; }
+  int capacity() const { return mCapacity; }
+  int first() const { return mFirst; }
+  
+  // setters:
+  void setData(const double *keys, const double *values, int size);
+  void setRing(const double *keys, const double *values, int capacity, int first, int size);
+  void setValueRange(bool foundRange, const QCPRange &range=QCPRange());
+  
+  // non-virtual methods:
+  void clear();
+  
+  // reimplemented virtual methods:
+  virtual int size() const Q_DECL_OVERRIDE { return mSize; }
+  virtual double keyAt(int index) const Q_DECL_OVERRIDE { return mKeys[position(index)]; }
+  virtual double valueAt(int index) const Q_DECL_OVERRIDE { return mValues[position(index)]; }
+  virtual int findBegin(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual int scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  const double *mKeys;
+  const double *mValues;
+  int mCapacity;
+  int mFirst;
+  int mSize;
+  bool mHasValueRange;
+  bool mValueRangeFound;
+  QCPRange mValueRange;
+  
+  // non-virtual methods:
+  int position(int index) const { const int p = mFirst+index; return p < mCapacity ? p : p-mCapacity; }
+  int headSize() const { return qMin(mSize, mCapacity-mFirst); }
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+};
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5522,6 +5602,7 @@ public:
   
   // getters:
   QSharedPointer<QCPGraphDataContainer> data() const { return mDataContainer; }
+  QSharedPointer<QCPGraphDataSource> dataSource() const { return mDataSource; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   int scatterSkip() const { return mScatterSkip; }
@@ -5531,6 +5612,7 @@ public:
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
   void setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void setDataSource(QSharedPointer<QCPGraphDataSource> source);
   void setLineStyle(LineStyle ls);
   void setScatterStyle(const QCPScatterStyle &style);
   void setScatterSkip(int skip);
@@ -5541,6 +5623,17 @@ public:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void addData(double key, double value);
   
+  // virtual methods of 1d plottable interface:
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
@@ -5554,6 +5647,9 @@ protected:
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  QSharedPointer<QCPGraphDataSource> mDataSource;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
@@ -5569,6 +5665,9 @@ protected:
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  void getVisibleDataBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const;
+  void getSourceLineData(QVector<QCPGraphData> *lineData, int begin, int end) const;
+  void getSourceScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
@@ -5587,6 +5686,7 @@ protected:
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const;
+  double pointDistance(const QPointF &pixelPoint, int &closestIndex) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -0,0 +1,855 @@
+#include "qcustomplot_containers.h"
+
+#include <cmath>
+
+namespace {
+
+/*! \internal
+
+  Expands \a lower and \a upper by the finite ones of \a values from \a begin to \a end, with the
+  comparisons of \ref QCPDataContainer::valueRange: a value only replaces a bound if it is strictly
+  smaller or larger. Start with \a lower at +Inf and \a upper at -Inf, they stay there if there is
+  no finite value.
+*/
+template <typename T>
+void qcpScanValueRange(const T *values, int begin, int end, double &lower, double &upper)
+{
+  for (int i=begin; i<end; ++i)
+  {
+    const double value = values[i];
+    if (std::isfinite(value)) // also false for NaN
+    {
+      if (value < lower)
+        lower = value;
+      if (value > upper)
+        upper = value;
+    }
+  }
+}
+
+} // anonymous namespace
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPValueRangeIndex
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPValueRangeIndex
+  \brief Answers value range queries over an array of values in logarithmic time
+
+  Keeps the minimum and maximum of every 256 values of an array in the leaves of a segment tree,
+  whose inner nodes hold the extremes of their children. The value range of any index range then
+  takes two partial leaves and O(log n) nodes, instead of a scan over all values. \ref
+  QCPGraphSoaDataContainer and \ref QCPGraphFloatDataContainer use it for their \ref
+  QCPGraphDataSource::valueRange, e.g. when a long history is rescaled to the visible key range.
+  The leaves are scanned one value at a time.
+
+  The owner passes its array with every query and calls \ref invalidateFrom when it changes
+  values. The index catches up lazily on the next query that is large enough to use it, so appends
+  cost nothing until then and only the changed leaves are computed again.
+
+  The results are identical to a scan in order with the comparisons of \ref
+  QCPDataContainer::valueRange, which ignores Inf and NaN and keeps the first of equal values, so
+  e.g. +0.0 and -0.0 come out as in the scan.
+*/
+
+/*!
+  Constructs an empty index.
+*/
+QCPValueRangeIndex::QCPValueRangeIndex() :
+  mLeaves(0),
+  mValid(0)
+{
+}
+
+/*!
+  Frees the tree. The next query builds it again.
+*/
+void QCPValueRangeIndex::clear()
+{
+  mLower.clear();
+  mUpper.clear();
+  mLeaves = 0;
+  mValid = 0;
+}
+
+/*!
+  Marks the values from the array index \a position on as changed, including values that were
+  removed or moved there.
+*/
+void QCPValueRangeIndex::invalidateFrom(int position)
+{
+  mValid = qMin(mValid, qMax(0, position));
+}
+
+/*!
+  Returns the range of the finite ones of \a values from the array index \a begin to \a end. The
+  array holds \a size values. The output parameter \a foundRange indicates whether there was a
+  finite value.
+*/
+QCPRange QCPValueRangeIndex::valueRange(bool &foundRange, const double *values, int size, int begin, int end)
+{
+  return query(foundRange, values, size, begin, end);
+}
+
+/*! \overload
+*/
+QCPRange QCPValueRangeIndex::valueRange(bool &foundRange, const float *values, int size, int begin, int end)
+{
+  return query(foundRange, values, size, begin, end);
+}
+
+/*! \internal
+
+  Brings the leaves and their ancestors up to date with the \a size values at \a values. Leaves
+  before the first invalidated value are kept, so after appends only the last leaves are computed
+  again. The tree grows to the next power of two of leaves when the array outgrows it.
+*/
+template <typename T>
+void QCPValueRangeIndex::update(const T *values, int size)
+{
+  const int blockSize = 1 << BlockBits;
+  const int blocks = (size+blockSize-1) >> BlockBits;
+  if (blocks > mLeaves)
+  {
+    mLeaves = qMax(1, mLeaves);
+    while (mLeaves < blocks)
+      mLeaves *= 2;
+    mLower.fill(std::numeric_limits<double>::infinity(), 2*mLeaves);
+    mUpper.fill(-std::numeric_limits<double>::infinity(), 2*mLeaves);
+    mValid = 0;
+  }
+  if (mValid >= size)
+    return;
+  
+  int first = mValid >> BlockBits;
+  int last = blocks-1;
+  for (int block=first; block<=last; ++block)
+  {
+    double lower = std::numeric_limits<double>::infinity();
+    double upper = -std::numeric_limits<double>::infinity();
+    qcpScanValueRange(values, block << BlockBits, qMin(size, (block+1) << BlockBits), lower, upper);
+    mLower[mLeaves+block] = lower;
+    mUpper[mLeaves+block] = upper;
+  }
+  // the ancestors of the changed leaves, level by level up to the root. Ties go to the left child,
+  // which holds the earlier values:
+  first = (mLeaves+first)/2;
+  last = (mLeaves+last)/2;
+  while (first >= 1)
+  {
+    for (int node=first; node<=last; ++node)
+    {
+      mLower[node] = mLower.at(2*node+1) < mLower.at(2*node) ? mLower.at(2*node+1) : mLower.at(2*node);
+      mUpper[node] = mUpper.at(2*node+1) > mUpper.at(2*node) ? mUpper.at(2*node+1) : mUpper.at(2*node);
+    }
+    first /= 2;
+    last /= 2;
+  }
+  mValid = size;
+}
+
+/*! \internal
+
+  Implements \ref valueRange for double and single precision values. Ranges of a few leaves are
+  scanned directly, larger ones take the partial leaves at either end and the nodes that cover the
+  whole leaves in between, combined in the order of the values.
+*/
+template <typename T>
+QCPRange QCPValueRangeIndex::query(bool &foundRange, const T *values, int size, int begin, int end)
+{
+  const int blockSize = 1 << BlockBits;
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -std::numeric_limits<double>::infinity();
+  if (end-begin < 4*blockSize)
+  {
+    qcpScanValueRange(values, begin, end, lower, upper);
+  } else
+  {
+    update(values, size);
+    const int firstLeaf = (begin+blockSize-1) >> BlockBits;
+    const int endLeaf = end >> BlockBits;
+    qcpScanValueRange(values, begin, firstLeaf << BlockBits, lower, upper);
+    // nodes from the left end combine after what came before, nodes from the right end before what
+    // comes after:
+    double rightLower = std::numeric_limits<double>::infinity();
+    double rightUpper = -std::numeric_limits<double>::infinity();
+    for (int left=mLeaves+firstLeaf, right=mLeaves+endLeaf; left<right; left/=2, right/=2)
+    {
+      if (left & 1)
+      {
+        if (mLower.at(left) < lower)
+          lower = mLower.at(left);
+        if (mUpper.at(left) > upper)
+          upper = mUpper.at(left);
+        ++left;
+      }
+      if (right & 1)
+      {
+        --right;
+        if (!(rightLower < mLower.at(right)))
+          rightLower = mLower.at(right);
+        if (!(rightUpper > mUpper.at(right)))
+          rightUpper = mUpper.at(right);
+      }
+    }
+    if (rightLower < lower)
+      lower = rightLower;
+    if (rightUpper > upper)
+      upper = rightUpper;
+    qcpScanValueRange(values, endLeaf << BlockBits, end, lower, upper);
+  }
+  foundRange = lower <= upper;
+  return foundRange ? QCPRange(lower, upper) : QCPRange();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphSoaDataContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphSoaDataContainer
+  \brief A graph data container with the keys and values in separate arrays
+
+  Holds the same data as a \ref QCPGraphDataContainer, but as one array of keys and one of values
+  (a structure of arrays) instead of one array of \ref QCPGraphData. Searching keys, scanning the
+  values for the value range and the minimum/maximum scan of the adaptive sampling then only read
+  the array they need, and the adaptive sampling scans several data points per instruction like a
+  \ref QCPGraphSpanDataSource (see \ref QCP::setSimdLevel). This pays off for graphs with many
+  points, such as long histories.
+
+  A graph draws the container after \ref QCPGraph::setDataSource. Several graphs may share one
+  container.
+
+  Like QCPDataContainer, the container keeps its data sorted by key. Appending keys that are
+  greater than or equal to the existing ones is fast, and \ref removeBefore only advances the
+  begin of the data, so the container suits streaming data.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn const double *QCPGraphSoaDataContainer::keys() const
+
+  Returns the array of the \ref size keys, in ascending order. It is valid until the container is
+  modified.
+*/
+
+/*! \fn const double *QCPGraphSoaDataContainer::values() const
+
+  Returns the array of the \ref size values, in the order of \ref keys. It is valid until the
+  container is modified.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty container.
+*/
+QCPGraphSoaDataContainer::QCPGraphSoaDataContainer() :
+  mBegin(0)
+{
+}
+
+/*!
+  Replaces the current data with the points in \a keys and \a values.
+
+  \see add
+*/
+void QCPGraphSoaDataContainer::set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  clear();
+  add(keys, values, alreadySorted);
+}
+
+/*! \overload
+
+  Adds the points in \a keys and \a values. The vectors should have equal length, else the number
+  of added points is the size of the smaller one.
+
+  If you can guarantee that \a keys are sorted in ascending order, set \a alreadySorted to true to
+  save a sorting run.
+*/
+void QCPGraphSoaDataContainer::add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  add(keys.constData(), values.constData(), int(qMin(keys.size(), values.size())), alreadySorted);
+}
+
+/*! \overload
+
+  Adds \a count points given as \a keys and \a values.
+*/
+void QCPGraphSoaDataContainer::add(const double *keys, const double *values, int count, bool alreadySorted)
+{
+  if (count <= 0)
+    return;
+  const int oldEnd = int(mKeys.size());
+  mKeys.resize(oldEnd+count);
+  mValues.resize(oldEnd+count);
+  std::copy(keys, keys+count, mKeys.begin()+oldEnd);
+  std::copy(values, values+count, mValues.begin()+oldEnd);
+  if (!alreadySorted)
+    sortFrom(oldEnd);
+  if (oldEnd > mBegin && mKeys.at(oldEnd) < mKeys.at(oldEnd-1)) // added keys aren't all greater than the existing ones
+  {
+    sortFrom(mBegin);
+    mRangeIndex.invalidateFrom(mBegin);
+  }
+  updateSpan();
+}
+
+/*! \overload
+
+  Adds the point \a key, \a value.
+*/
+void QCPGraphSoaDataContainer::add(double key, double value)
+{
+  if (isEmpty() || !(key < mKeys.last())) // quickly handle appends if the new key is greater or equal to the existing ones
+  {
+    mKeys.append(key);
+    mValues.append(value);
+  } else if (key < mKeys.at(mBegin) && mBegin > 0) // prepend into the space of removed points
+  {
+    --mBegin;
+    mKeys[mBegin] = key;
+    mValues[mBegin] = value;
+    mRangeIndex.invalidateFrom(mBegin);
+  } else
+  {
+    const int index = int(std::lower_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-mKeys.constBegin());
+    mKeys.insert(index, key);
+    mValues.insert(index, value);
+    mRangeIndex.invalidateFrom(index);
+  }
+  updateSpan();
+}
+
+/*!
+  Removes all points with keys smaller than \a key. This only advances the begin of the data, the
+  memory is reused once the removed points outnumber the remaining ones.
+
+  \see removeAfter, remove, clear
+*/
+void QCPGraphSoaDataContainer::removeBefore(double key)
+{
+  mBegin = int(std::lower_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-mKeys.constBegin());
+  performAutoSqueeze();
+  updateSpan();
+}
+
+/*!
+  Removes all points with keys greater than \a key.
+
+  \see removeBefore, remove, clear
+*/
+void QCPGraphSoaDataContainer::removeAfter(double key)
+{
+  const int index = int(std::upper_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), key)-mKeys.constBegin());
+  mKeys.resize(index);
+  mValues.resize(index);
+  mRangeIndex.invalidateFrom(index);
+  updateSpan();
+}
+
+/*!
+  Removes all points with keys between \a keyFrom and \a keyTo.
+
+  \see removeBefore, removeAfter, clear
+*/
+void QCPGraphSoaDataContainer::remove(double keyFrom, double keyTo)
+{
+  if (keyFrom >= keyTo || isEmpty())
+    return;
+  QVector<double>::const_iterator it = std::lower_bound(mKeys.constBegin()+mBegin, mKeys.constEnd(), keyFrom);
+  QVector<double>::const_iterator itEnd = std::upper_bound(it, mKeys.constEnd(), keyTo);
+  const int index = int(it-mKeys.constBegin());
+  const int count = int(itEnd-it);
+  mKeys.remove(index, count);
+  mValues.remove(index, count);
+  mRangeIndex.invalidateFrom(index);
+  updateSpan();
+}
+
+/*!
+  Removes all points.
+*/
+void QCPGraphSoaDataContainer::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mBegin = 0;
+  mRangeIndex.clear();
+  mSpan.clear();
+}
+
+/*!
+  Frees the memory of removed points and the unused capacity of the arrays.
+*/
+void QCPGraphSoaDataContainer::squeeze()
+{
+  if (mBegin > 0)
+  {
+    mKeys.remove(0, mBegin);
+    mValues.remove(0, mBegin);
+    mBegin = 0;
+    mRangeIndex.invalidateFrom(0);
+  }
+  mKeys.squeeze();
+  mValues.squeeze();
+  updateSpan();
+}
+
+/* inherits documentation from base class */
+int QCPGraphSoaDataContainer::findBegin(double key, bool expandedRange) const
+{
+  const double *k = keys();
+  int index = int(std::lower_bound(k, k+size(), key)-k);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/* inherits documentation from base class */
+int QCPGraphSoaDataContainer::findEnd(double key, bool expandedRange) const
+{
+  const double *k = keys();
+  int index = int(std::upper_bound(k, k+size(), key)-k);
+  if (expandedRange && index < size())
+    ++index;
+  return index;
+}
+
+/*!
+  \copydoc QCPGraphDataSource::valueRange
+
+  For both sign domains, this takes the value range from a \ref QCPValueRangeIndex in O(log n),
+  or for short key ranges scans the value array.
+*/
+QCPRange QCPGraphSoaDataContainer::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  if (signDomain != QCP::sdBoth) // only log axes ask for one sign domain
+    return QCPGraphDataSource::valueRange(foundRange, signDomain, inKeyRange);
+  
+  int begin = 0;
+  int end = size();
+  if (inKeyRange != QCPRange())
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  return mRangeIndex.valueRange(foundRange, mValues.constData(), int(mValues.size()), mBegin+begin, mBegin+end);
+}
+
+/* inherits documentation from base class */
+int QCPGraphSoaDataContainer::scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const
+{
+  return mSpan.scanInterval(begin, end, keyLimit, minValue, maxValue);
+}
+
+/*! \internal
+
+  Sorts the points from the array index \a index on by key. Points with equal keys keep their
+  order.
+*/
+void QCPGraphSoaDataContainer::sortFrom(int index)
+{
+  if (std::is_sorted(mKeys.constBegin()+index, mKeys.constEnd()))
+    return;
+  QVector<QCPGraphData> points(int(mKeys.size())-index);
+  for (int i=0; i<points.size(); ++i)
+    points[i] = QCPGraphData(mKeys.at(index+i), mValues.at(index+i));
+  std::stable_sort(points.begin(), points.end(), qcpLessThanSortKey<QCPGraphData>);
+  for (int i=0; i<points.size(); ++i)
+  {
+    mKeys[index+i] = points.at(i).key;
+    mValues[index+i] = points.at(i).value;
+  }
+}
+
+/*! \internal
+
+  Drops the points removed by \ref removeBefore from the arrays once they outnumber the remaining
+  ones, so each point is moved at most once on average.
+*/
+void QCPGraphSoaDataContainer::performAutoSqueeze()
+{
+  if (mBegin > 1000 && mBegin > size())
+  {
+    mKeys.remove(0, mBegin);
+    mValues.remove(0, mBegin);
+    mBegin = 0;
+    mRangeIndex.invalidateFrom(0);
+  }
+}
+
+/*! \internal
+
+  Points \ref mSpan at the arrays again, after they were modified and may have moved.
+*/
+void QCPGraphSoaDataContainer::updateSpan()
+{
+  mSpan.setData(keys(), values(), size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphFloatDataContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphFloatDataContainer
+  \brief A graph data container that stores its points in single precision
+
+  Holds the same data as a \ref QCPGraphSoaDataContainer in half the memory, 8 instead of 16 bytes
+  per data point. Drawing, rescaling and the adaptive sampling read half as many bytes, which
+  matters for graphs with millions of points, such as long histories of data that was single
+  precision to begin with.
+
+  Values are stored as float, which keeps about seven significant digits, far more than a plot can
+  resolve. Keys such as timestamps need more than that, so each block of 4096 consecutive points
+  stores its keys as float offsets from the key of the block's first point, which is kept as
+  double. A key is then precise to about seven digits of the key span of its block, not of its
+  absolute value. Offsets are rounded towards zero, so the stored keys stay sorted.
+
+  A graph draws the container after \ref QCPGraph::setDataSource. Several graphs may share one
+  container.
+
+  Appending keys that are greater than or equal to the existing ones and \ref removeBefore are as
+  fast as in QCPGraphSoaDataContainer. Adding points between existing ones re-encodes all points
+  after them, which costs as much as a full copy.
+*/
+
+/*!
+  Constructs an empty container.
+*/
+QCPGraphFloatDataContainer::QCPGraphFloatDataContainer() :
+  mBegin(0)
+{
+}
+
+/*!
+  Replaces the current data with the points in \a keys and \a values.
+
+  \see add
+*/
+void QCPGraphFloatDataContainer::set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  clear();
+  add(keys, values, alreadySorted);
+}
+
+/*! \overload
+
+  Adds the points in \a keys and \a values. The vectors should have equal length, else the number
+  of added points is the size of the smaller one.
+
+  If you can guarantee that \a keys are sorted in ascending order, set \a alreadySorted to true to
+  save a sorting run.
+*/
+void QCPGraphFloatDataContainer::add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
+{
+  if (keys.size() != values.size())
+    qDebug() << Q_FUNC_INFO << "keys and values have different sizes:" << keys.size() << values.size();
+  add(keys.constData(), values.constData(), int(qMin(keys.size(), values.size())), alreadySorted);
+}
+
+/*! \overload
+
+  Adds \a count points given as \a keys and \a values.
+*/
+void QCPGraphFloatDataContainer::add(const double *keys, const double *values, int count, bool alreadySorted)
+{
+  if (count <= 0)
+    return;
+  QVector<QCPGraphData> points;
+  if (!alreadySorted && !std::is_sorted(keys, keys+count))
+  {
+    points.resize(count);
+    for (int i=0; i<count; ++i)
+      points[i] = QCPGraphData(keys[i], values[i]);
+    std::stable_sort(points.begin(), points.end(), qcpLessThanSortKey<QCPGraphData>);
+  }
+  const double firstKey = points.isEmpty() ? keys[0] : points.first().key;
+  if (isEmpty() || !(firstKey < storedKey(int(mKeys.size())-1))) // quickly handle appends if the added keys are greater or equal to the existing ones
+  {
+    if (points.isEmpty())
+    {
+      for (int i=0; i<count; ++i)
+        append(keys[i], values[i]);
+    } else
+    {
+      for (int i=0; i<count; ++i)
+        append(points.at(i).key, points.at(i).value);
+    }
+    return;
+  }
+  
+  if (points.isEmpty())
+  {
+    points.resize(count);
+    for (int i=0; i<count; ++i)
+      points[i] = QCPGraphData(keys[i], values[i]);
+  }
+  // merge the added points with the existing ones from the first key that is greater, existing
+  // points with equal keys stay in front like in a stable sort:
+  const int index = upperBound(firstKey);
+  QVector<QCPGraphData> tail(size()-index);
+  for (int i=0; i<tail.size(); ++i)
+    tail[i] = QCPGraphData(keyAt(index+i), valueAt(index+i));
+  QVector<QCPGraphData> merged(tail.size()+points.size());
+  std::merge(tail.constBegin(), tail.constEnd(), points.constBegin(), points.constEnd(), merged.begin(), qcpLessThanSortKey<QCPGraphData>);
+  rewriteFrom(index, merged);
+}
+
+/*! \overload
+
+  Adds the point \a key, \a value.
+*/
+void QCPGraphFloatDataContainer::add(double key, double value)
+{
+  if (isEmpty() || !(key < storedKey(int(mKeys.size())-1))) // quickly handle appends if the new key is greater or equal to the existing ones
+  {
+    append(key, value);
+  } else
+  {
+    const int index = lowerBound(key);
+    QVector<QCPGraphData> points(size()-index+1);
+    points[0] = QCPGraphData(key, value);
+    for (int i=1; i<points.size(); ++i)
+      points[i] = QCPGraphData(keyAt(index+i-1), valueAt(index+i-1));
+    rewriteFrom(index, points);
+  }
+}
+
+/*!
+  Removes all points with keys smaller than \a key. This only advances the begin of the data, the
+  memory is reused once the removed points outnumber the remaining ones.
+
+  \see removeAfter, remove, clear
+*/
+void QCPGraphFloatDataContainer::removeBefore(double key)
+{
+  mBegin += lowerBound(key);
+  if (isEmpty())
+    clear(); // the next point may be smaller than the origin of the current block
+  else
+    performAutoSqueeze();
+}
+
+/*!
+  Removes all points with keys greater than \a key.
+
+  \see removeBefore, remove, clear
+*/
+void QCPGraphFloatDataContainer::removeAfter(double key)
+{
+  rewriteFrom(upperBound(key), QVector<QCPGraphData>());
+}
+
+/*!
+  Removes all points with keys between \a keyFrom and \a keyTo.
+
+  \see removeBefore, removeAfter, clear
+*/
+void QCPGraphFloatDataContainer::remove(double keyFrom, double keyTo)
+{
+  if (keyFrom >= keyTo || isEmpty())
+    return;
+  const int index = lowerBound(keyFrom);
+  const int indexEnd = upperBound(keyTo);
+  if (index == indexEnd)
+    return;
+  QVector<QCPGraphData> tail(size()-indexEnd);
+  for (int i=0; i<tail.size(); ++i)
+    tail[i] = QCPGraphData(keyAt(indexEnd+i), valueAt(indexEnd+i));
+  rewriteFrom(index, tail);
+}
+
+/*!
+  Removes all points.
+*/
+void QCPGraphFloatDataContainer::clear()
+{
+  mKeys.clear();
+  mValues.clear();
+  mOrigins.clear();
+  mBegin = 0;
+  mRangeIndex.clear();
+}
+
+/*!
+  Frees the memory of removed points and the unused capacity of the arrays. Removed points are
+  freed in whole blocks of 4096, since the remaining points of a block refer to its first key.
+*/
+void QCPGraphFloatDataContainer::squeeze()
+{
+  const int blocks = mBegin >> BlockBits;
+  if (blocks > 0)
+  {
+    mKeys.remove(0, blocks << BlockBits);
+    mValues.remove(0, blocks << BlockBits);
+    mOrigins.remove(0, blocks);
+    mBegin -= blocks << BlockBits;
+    mRangeIndex.invalidateFrom(0);
+  }
+  mKeys.squeeze();
+  mValues.squeeze();
+  mOrigins.squeeze();
+}
+
+/* inherits documentation from base class */
+int QCPGraphFloatDataContainer::findBegin(double key, bool expandedRange) const
+{
+  int index = lowerBound(key);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/* inherits documentation from base class */
+int QCPGraphFloatDataContainer::findEnd(double key, bool expandedRange) const
+{
+  int index = upperBound(key);
+  if (expandedRange && index < size())
+    ++index;
+  return index;
+}
+
+/*!
+  \copydoc QCPGraphDataSource::valueRange
+
+  For both sign domains, this takes the value range from a \ref QCPValueRangeIndex in O(log n),
+  or for short key ranges scans the value array.
+*/
+QCPRange QCPGraphFloatDataContainer::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  if (signDomain != QCP::sdBoth) // only log axes ask for one sign domain
+    return QCPGraphDataSource::valueRange(foundRange, signDomain, inKeyRange);
+  
+  int begin = 0;
+  int end = size();
+  if (inKeyRange != QCPRange())
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  return mRangeIndex.valueRange(foundRange, mValues.constData(), int(mValues.size()), mBegin+begin, mBegin+end);
+}
+
+/* inherits documentation from base class */
+int QCPGraphFloatDataContainer::scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const
+{
+  int it = mBegin+begin;
+  const int itEnd = mBegin+end;
+  while (it != itEnd && storedKey(it) < keyLimit)
+  {
+    const double value = mValues.at(it);
+    if (value < minValue)
+      minValue = value;
+    else if (value > maxValue)
+      maxValue = value;
+    ++it;
+  }
+  return it-mBegin;
+}
+
+/*! \fn double QCPGraphFloatDataContainer::storedKey(int position) const
+  \internal
+
+  Returns the key at the array position \a position, which counts removed points, from the origin
+  of its block and its offset.
+*/
+
+/*! \internal
+
+  Returns the index of the first point with a key not smaller than \a key.
+*/
+int QCPGraphFloatDataContainer::lowerBound(double key) const
+{
+  int lower = mBegin;
+  int upper = int(mKeys.size());
+  while (lower < upper)
+  {
+    const int middle = lower+(upper-lower)/2;
+    if (storedKey(middle) < key)
+      lower = middle+1;
+    else
+      upper = middle;
+  }
+  return lower-mBegin;
+}
+
+/*! \internal
+
+  Returns the index of the first point with a key greater than \a key.
+*/
+int QCPGraphFloatDataContainer::upperBound(double key) const
+{
+  int lower = mBegin;
+  int upper = int(mKeys.size());
+  while (lower < upper)
+  {
+    const int middle = lower+(upper-lower)/2;
+    if (key < storedKey(middle))
+      upper = middle;
+    else
+      lower = middle+1;
+  }
+  return lower-mBegin;
+}
+
+/*! \internal
+
+  Appends the point \a key, \a value, whose key must not be smaller than the last one. The first
+  point of a block becomes its origin.
+*/
+void QCPGraphFloatDataContainer::append(double key, double value)
+{
+  if ((mKeys.size() & ((1 << BlockBits)-1)) == 0)
+    mOrigins.append(key);
+  const double offset = key-mOrigins.last();
+  float storedOffset = float(offset);
+  if (storedOffset > offset) // round towards the origin, so the last keys of a block can't exceed the next block's origin
+    storedOffset = std::nextafter(storedOffset, 0.0f);
+  mKeys.append(storedOffset);
+  mValues.append(float(value));
+}
+
+/*! \internal
+
+  Replaces the points from the index \a index on with \a points, which must be sorted and not
+  smaller than the point before \a index. The points before \a index keep their stored keys.
+*/
+void QCPGraphFloatDataContainer::rewriteFrom(int index, const QVector<QCPGraphData> &points)
+{
+  if (index == 0)
+  {
+    clear(); // no point remains to anchor the origin of the current block
+  } else
+  {
+    const int position = mBegin+index;
+    mKeys.resize(position);
+    mValues.resize(position);
+    mOrigins.resize(((position-1) >> BlockBits)+1);
+    mRangeIndex.invalidateFrom(position);
+  }
+  for (int i=0; i<points.size(); ++i)
+    append(points.at(i).key, points.at(i).value);
+}
+
+/*! \internal
+
+  Drops the blocks of points removed by \ref removeBefore from the arrays once the removed points
+  outnumber the remaining ones, so each point is moved at most once on average.
+*/
+void QCPGraphFloatDataContainer::performAutoSqueeze()
+{
+  const int blocks = mBegin >> BlockBits;
+  if (blocks > 0 && mBegin > size())
+  {
+    mKeys.remove(0, blocks << BlockBits);
+    mValues.remove(0, blocks << BlockBits);
+    mOrigins.remove(0, blocks);
+    mBegin -= blocks << BlockBits;
+    mRangeIndex.invalidateFrom(0);
+  }
+}
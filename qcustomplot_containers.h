@@ -0,0 +1,124 @@
+#ifndef QCUSTOMPLOT_CONTAINERS_H
+#define QCUSTOMPLOT_CONTAINERS_H
+
+// Optional data containers for QCPGraph, see QCPGraph::setDataSource: keys and
+// values in separate arrays, or in single precision, with a segment tree for
+// their value ranges. dock-gs draws its plots straight from the telemetry
+// store through QCPGraphSpanDataSource and doesn't use them, only the
+// benchmarks build this.
+
+#include "qcustomplot.h"
+
+class QCP_LIB_DECL QCPValueRangeIndex
+{
+public:
+  QCPValueRangeIndex();
+  
+  // non-virtual methods:
+  void clear();
+  void invalidateFrom(int position);
+  QCPRange valueRange(bool &foundRange, const double *values, int size, int begin, int end);
+  QCPRange valueRange(bool &foundRange, const float *values, int size, int begin, int end);
+  
+protected:
+  enum { BlockBits = 8 }; // 256 values per leaf
+  
+  // non-property members:
+  QVector<double> mLower; // nodes of a segment tree, the leaves start at index mLeaves
+  QVector<double> mUpper;
+  int mLeaves;
+  int mValid;
+  
+  // non-virtual methods:
+  template <typename T> void update(const T *values, int size);
+  template <typename T> QCPRange query(bool &foundRange, const T *values, int size, int begin, int end);
+};
+
+class QCP_LIB_DECL QCPGraphSoaDataContainer : public QCPGraphDataSource
+{
+public:
+  QCPGraphSoaDataContainer();
+
+  // getters:
+  const double *keys() const { return mKeys.constData()+mBegin; }
+  const double *values() const { return mValues.constData()+mBegin; }
+
+  // non-virtual methods:
+  void set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const double *keys, const double *values, int count, bool alreadySorted=false);
+  void add(double key, double value);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double keyFrom, double keyTo);
+  void clear();
+  void squeeze();
+
+  // reimplemented virtual methods:
+  virtual int size() const Q_DECL_OVERRIDE { return int(mKeys.size())-mBegin; }
+  virtual double keyAt(int index) const Q_DECL_OVERRIDE { return mKeys.at(mBegin+index); }
+  virtual double valueAt(int index) const Q_DECL_OVERRIDE { return mValues.at(mBegin+index); }
+  virtual int findBegin(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual int scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const Q_DECL_OVERRIDE;
+
+protected:
+  // non-property members:
+  QVector<double> mKeys;
+  QVector<double> mValues;
+  int mBegin;
+  mutable QCPValueRangeIndex mRangeIndex;
+  QCPGraphSpanDataSource mSpan; // the arrays from mBegin on, for its vectorized scans
+
+  // non-virtual methods:
+  void sortFrom(int index);
+  void performAutoSqueeze();
+  void updateSpan();
+};
+
+class QCP_LIB_DECL QCPGraphFloatDataContainer : public QCPGraphDataSource
+{
+public:
+  QCPGraphFloatDataContainer();
+
+  // non-virtual methods:
+  void set(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void add(const double *keys, const double *values, int count, bool alreadySorted=false);
+  void add(double key, double value);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double keyFrom, double keyTo);
+  void clear();
+  void squeeze();
+
+  // reimplemented virtual methods:
+  virtual int size() const Q_DECL_OVERRIDE { return int(mKeys.size())-mBegin; }
+  virtual double keyAt(int index) const Q_DECL_OVERRIDE { return storedKey(mBegin+index); }
+  virtual double valueAt(int index) const Q_DECL_OVERRIDE { return mValues.at(mBegin+index); }
+  virtual int findBegin(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double key, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual int scanInterval(int begin, int end, double keyLimit, double &minValue, double &maxValue) const Q_DECL_OVERRIDE;
+
+protected:
+  enum { BlockBits = 12 }; // 4096 points share one key origin
+
+  // non-property members:
+  QVector<float> mKeys; // offsets from the origin of their block
+  QVector<float> mValues;
+  QVector<double> mOrigins;
+  int mBegin;
+  mutable QCPValueRangeIndex mRangeIndex;
+
+  // non-virtual methods:
+  double storedKey(int position) const { return mOrigins.at(position >> BlockBits)+mKeys.at(position); }
+  int lowerBound(double key) const;
+  int upperBound(double key) const;
+  void append(double key, double value);
+  void rewriteFrom(int index, const QVector<QCPGraphData> &points);
+  void performAutoSqueeze();
+};
+
+#endif // QCUSTOMPLOT_CONTAINERS_H
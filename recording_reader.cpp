@@ -0,0 +1,174 @@
+#include "recording_reader.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+bool RecordingReader::open(const QString &path)
+{
+    close();
+
+    // "dock-gs-<date>-<time>-<segment>.rec", the other segments share the base
+    static const QRegularExpression segment_name("^(.*)-\\d+\\.rec$");
+    QRegularExpressionMatch match = segment_name.match(path);
+
+    if (!match.hasMatch())
+    {
+        qDebug() << "Not a recording segment:" << path;
+        return false;
+    }
+
+    const QString base = match.captured(1);
+
+    for (uint32_t i = 0;; i++)
+    {
+        QString name = base + QString("-%1.rec").arg(i, 3, 10, QChar('0'));
+
+        if (!QFile::exists(name) || !open_segment(name))
+        {
+            break;
+        }
+    }
+
+    if (segments.empty())
+    {
+        return false;
+    }
+
+    // One pass over the headers for the index
+    record_pos_t pos = begin();
+    record_pos_t at = pos;
+    recorder_record_t header;
+    QByteArrayView data;
+    int64_t latest = 0;
+
+    while (next(pos, header, data))
+    {
+        if (records == 0)
+        {
+            first_ns = header.time_ns;
+            latest = header.time_ns;
+        }
+
+        latest = qMax(latest, header.time_ns);
+
+        if (records % RECORDING_INDEX_STRIDE == 0)
+        {
+            index.push_back({latest, at});
+        }
+
+        records++;
+        at = pos;
+    }
+
+    last_ns = latest;
+    return true;
+}
+
+void RecordingReader::close()
+{
+    for (segment_t &s : segments)
+    {
+        s.file->unmap(const_cast<uchar *>(s.data));
+    }
+
+    segments.clear();
+    index.clear();
+    records = 0;
+    first_ns = 0;
+    last_ns = 0;
+}
+
+bool RecordingReader::open_segment(const QString &path)
+{
+    segment_t s;
+    s.file.reset(new QFile(path));
+
+    if (!s.file->open(QIODevice::ReadOnly) || s.file->size() < qint64(sizeof(recorder_segment_t)))
+    {
+        qDebug() << "Failed to open" << path << s.file->errorString();
+        return false;
+    }
+
+    s.size = size_t(s.file->size());
+    s.data = s.file->map(0, qint64(s.size));
+
+    if (!s.data)
+    {
+        qDebug() << "Failed to map" << path << s.file->errorString();
+        return false;
+    }
+
+    recorder_segment_t header;
+    memcpy(&header, s.data, sizeof(header));
+
+    if (memcmp(header.magic, RECORDER_MAGIC, sizeof(RECORDER_MAGIC)) != 0 ||
+        header.version != RECORDER_VERSION || header.header_size != sizeof(recorder_segment_t))
+    {
+        qDebug() << "Not a recording segment:" << path;
+        s.file->unmap(const_cast<uchar *>(s.data));
+        return false;
+    }
+
+    segments.push_back(std::move(s));
+    return true;
+}
+
+record_pos_t RecordingReader::seek(int64_t time_ns) const
+{
+    if (index.empty())
+    {
+        return begin();
+    }
+
+    // Last index entry before time_ns, the timestamps in the index never
+    // decrease even if a few records were written out of order
+    auto it = std::lower_bound(index.begin(), index.end(), time_ns,
+                               [](const index_entry_t &e, int64_t t) { return e.time_ns < t; });
+
+    record_pos_t pos = it == index.begin() ? begin() : std::prev(it)->pos;
+    record_pos_t at = pos;
+    recorder_record_t header;
+    QByteArrayView data;
+
+    while (next(pos, header, data))
+    {
+        if (header.time_ns >= time_ns)
+        {
+            return at;
+        }
+
+        at = pos;
+    }
+
+    return pos;
+}
+
+bool RecordingReader::next(record_pos_t &pos, recorder_record_t &header, QByteArrayView &data) const
+{
+    while (pos.segment < segments.size())
+    {
+        const segment_t &s = segments[pos.segment];
+
+        if (pos.offset + sizeof(recorder_record_t) <= s.size)
+        {
+            memcpy(&header, s.data + pos.offset, sizeof(header));
+
+            // A zero length ends a segment that was not closed cleanly
+            if (header.length > 0 && pos.offset + sizeof(recorder_record_t) + header.length <= s.size)
+            {
+                data = QByteArrayView(s.data + pos.offset + sizeof(recorder_record_t), qsizetype(header.length));
+                pos.offset += uint32_t(sizeof(recorder_record_t) + header.length);
+                return true;
+            }
+        }
+
+        pos.segment++;
+        pos.offset = uint32_t(sizeof(recorder_segment_t));
+    }
+
+    return false;
+}
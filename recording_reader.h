@@ -0,0 +1,80 @@
+#ifndef RECORDING_READER_H
+#define RECORDING_READER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "flight_recorder.h"
+
+// Records between two entries of the sparse time index
+#define RECORDING_INDEX_STRIDE 256
+
+// Position of a record within a recording
+typedef struct
+{
+    uint32_t segment;
+    uint32_t offset; // Byte offset of the record header in the segment
+} record_pos_t;
+
+// Read-only view of a recording written by FlightRecorder. All segments are
+// memory-mapped, records are read in place. Opening scans the record headers
+// once to build a sparse time index, so seek() is a binary search plus at
+// most RECORDING_INDEX_STRIDE records.
+class RecordingReader
+{
+public:
+    RecordingReader() = default;
+
+    RecordingReader(const RecordingReader &) = delete;
+    RecordingReader &operator=(const RecordingReader &) = delete;
+
+    // Opens the recording that the segment file at path belongs to
+    bool open(const QString &path);
+
+    void close();
+
+    bool is_open() const { return !segments.empty(); }
+
+    uint64_t count() const { return records; }
+
+    // Wall clock [ns] of the first and the latest record
+    int64_t start_ns() const { return first_ns; }
+    int64_t end_ns() const { return last_ns; }
+
+    record_pos_t begin() const { return {0, uint32_t(sizeof(recorder_segment_t))}; }
+
+    // First record at or after time_ns, or the end
+    record_pos_t seek(int64_t time_ns) const;
+
+    // Reads the record at pos and moves pos to the next one, false at the end
+    bool next(record_pos_t &pos, recorder_record_t &header, QByteArrayView &data) const;
+
+private:
+    typedef struct
+    {
+        int64_t time_ns; // Latest timestamp up to and including this record
+        record_pos_t pos;
+    } index_entry_t;
+
+    typedef struct
+    {
+        std::unique_ptr<QFile> file;
+        const uchar *data;
+        size_t size;
+    } segment_t;
+
+    bool open_segment(const QString &path);
+
+    std::vector<segment_t> segments;
+    std::vector<index_entry_t> index;
+    uint64_t records = 0;
+    int64_t first_ns = 0;
+    int64_t last_ns = 0;
+};
+
+#endif // RECORDING_READER_H
@@ -0,0 +1,191 @@
+#include "replay_engine.h"
+
+#include <limits>
+
+#include "flight_recorder.h"
+#include "telemetry.h"
+
+ReplayEngine::ReplayEngine(QObject *parent)
+    : QObject(parent)
+{
+    connect(&timer, &QTimer::timeout, this, &ReplayEngine::tick);
+}
+
+bool ReplayEngine::open(const QString &path)
+{
+    close();
+
+    if (!reader.open(path))
+    {
+        return false;
+    }
+
+    pos = reader.begin();
+    return true;
+}
+
+void ReplayEngine::close()
+{
+    timer.stop();
+    reader.close();
+    pos = {0, 0};
+    position = 0;
+    frame_count = 0;
+    corrupt_count = 0;
+    crc_mismatch_count = 0;
+    sent_count = 0;
+}
+
+void ReplayEngine::set_speed(double speed)
+{
+    // Keep the replay clock continuous across the change
+    if (timer.isActive())
+    {
+        wall_origin_ns = position;
+        wall.start();
+    }
+
+    replay_speed = qMax(0.0, speed);
+    timer.setInterval(replay_speed > 0 ? REPLAY_TICK_MILLIS : 0);
+}
+
+void ReplayEngine::play()
+{
+    if (!reader.is_open() || timer.isActive())
+    {
+        return;
+    }
+
+    wall_origin_ns = position;
+    wall.start();
+    timer.start(replay_speed > 0 ? REPLAY_TICK_MILLIS : 0);
+}
+
+void ReplayEngine::pause()
+{
+    timer.stop();
+}
+
+void ReplayEngine::seek(qint64 offset_ns)
+{
+    pos = reader.seek(reader.start_ns() + offset_ns);
+    position = offset_ns;
+    wall_origin_ns = position;
+    wall.start();
+
+    emit progress(position);
+}
+
+uint64_t ReplayEngine::run()
+{
+    const uint64_t before = frame_count;
+
+    replay(std::numeric_limits<int64_t>::max(), std::numeric_limits<uint64_t>::max());
+
+    emit progress(position);
+    return frame_count - before;
+}
+
+void ReplayEngine::tick()
+{
+    bool more;
+
+    if (replay_speed > 0)
+    {
+        more = replay(wall_origin_ns + int64_t(wall.nsecsElapsed() * replay_speed), std::numeric_limits<uint64_t>::max());
+    }
+    else
+    {
+        more = replay(std::numeric_limits<int64_t>::max(), REPLAY_CHUNK_FRAMES);
+    }
+
+    emit progress(position);
+
+    if (!more)
+    {
+        timer.stop();
+        emit finished();
+    }
+}
+
+bool ReplayEngine::replay(int64_t until_ns, uint64_t max_frames)
+{
+    telemetry_rx_t batch[REPLAY_BATCH];
+    size_t n = 0;
+    uint64_t replayed = 0;
+    bool more = true;
+
+    recorder_record_t header;
+    QByteArrayView data;
+
+    while (replayed < max_frames)
+    {
+        record_pos_t at = pos;
+
+        if (!reader.next(pos, header, data))
+        {
+            more = false;
+            break;
+        }
+
+        const int64_t rx_ns = header.time_ns - reader.start_ns();
+
+        if (rx_ns > until_ns)
+        {
+            // Not due yet
+            pos = at;
+            break;
+        }
+
+        position = qMax(position, rx_ns);
+
+        if (header.direction != RECORD_RX)
+        {
+            sent_count++;
+            continue;
+        }
+
+        telemetry_rx_t &frame = batch[n];
+
+        // Cut off on the live link as well, never decoded there
+        if ((header.flags & RECORD_FLAG_TRUNCATED) || !decode_telemetry(data, frame.t))
+        {
+            corrupt_count++;
+            continue;
+        }
+
+        // As on the live link
+        if (!check_telemetry_crc(data, frame.t))
+        {
+            crc_mismatch_count++;
+
+            if (telemetry_crc_enforced(data))
+            {
+                corrupt_count++;
+                continue;
+            }
+        }
+
+        frame.rx_ns = rx_ns;
+        frame.src = recorder_record_endpoint(header);
+        replayed++;
+
+        if (++n == REPLAY_BATCH)
+        {
+            if (deliver)
+            {
+                deliver(batch, n, position);
+            }
+
+            n = 0;
+        }
+    }
+
+    if (n > 0 && deliver)
+    {
+        deliver(batch, n, position);
+    }
+
+    frame_count += replayed;
+    return more;
+}
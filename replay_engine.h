@@ -0,0 +1,102 @@
+#ifndef REPLAY_ENGINE_H
+#define REPLAY_ENGINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <cstdint>
+#include <functional>
+
+#include "recording_reader.h"
+#include "udp_link.h"
+
+// Timer interval while replaying at a finite speed
+#define REPLAY_TICK_MILLIS 10
+
+// Frames replayed per event loop turn at maximum speed
+#define REPLAY_CHUNK_FRAMES 4096
+
+// Frames handed to the sink per call
+#define REPLAY_BATCH 64
+
+// Feeds a recording through the receive path: received datagrams are decoded
+// and CRC checked like on the link and handed to the sink with rx_ns on the
+// replay clock, ns since the first record. Sent datagrams are skipped.
+// Replays at a multiple of real time, paced on the event loop, or as fast as
+// possible.
+class ReplayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Takes frames, now_ns is the replay clock when they are delivered
+    typedef std::function<void(const telemetry_rx_t *frames, size_t n, int64_t now_ns)> sink_t;
+
+    explicit ReplayEngine(QObject *parent = nullptr);
+
+    bool open(const QString &path);
+
+    void close();
+
+    const RecordingReader &recording() const { return reader; }
+
+    void set_sink(sink_t sink) { deliver = std::move(sink); }
+
+    // 1 is real time, 0 as fast as possible
+    void set_speed(double speed);
+
+    double speed() const { return replay_speed; }
+
+    bool is_playing() const { return timer.isActive(); }
+
+    // Replay clock [ns] of the last record read
+    int64_t position_ns() const { return position; }
+
+    int64_t duration_ns() const { return reader.end_ns() - reader.start_ns(); }
+
+    uint64_t frames() const { return frame_count; }
+    uint64_t corrupt() const { return corrupt_count; }
+    uint64_t crc_mismatches() const { return crc_mismatch_count; }
+    uint64_t sent() const { return sent_count; }
+
+    // Replays the rest of the recording without an event loop, returns the
+    // number of frames
+    uint64_t run();
+
+public slots:
+    void play();
+
+    void pause();
+
+    // Continues at offset_ns on the replay clock
+    void seek(qint64 offset_ns);
+
+signals:
+    void progress(qint64 position_ns);
+
+    void finished();
+
+private slots:
+    void tick();
+
+private:
+    // Replays records up to the replay clock until_ns, at most max_frames
+    // frames. Returns false at the end of the recording.
+    bool replay(int64_t until_ns, uint64_t max_frames);
+
+    RecordingReader reader;
+    record_pos_t pos = {0, 0};
+    sink_t deliver;
+    double replay_speed = 1.0;
+    QTimer timer;
+    QElapsedTimer wall;
+    int64_t wall_origin_ns = 0; // Replay clock when wall was started
+    int64_t position = 0;
+    uint64_t frame_count = 0;
+    uint64_t corrupt_count = 0;
+    uint64_t crc_mismatch_count = 0;
+    uint64_t sent_count = 0;
+};
+
+#endif // REPLAY_ENGINE_H
@@ -0,0 +1,120 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTextStream>
+
+#include <cstdio>
+
+#include "replay_engine.h"
+#include "session_manager.h"
+
+// Headless replay of a recording, prints the docking state changes of every
+// unit and a summary of the link per unit
+
+static const char *state_name(enum dock_state state)
+{
+    switch (state)
+    {
+    case DOCK_STATE_START: return "START";
+    case DOCK_STATE_IDLE: return "IDLE";
+    case DOCK_STATE_CAPTURE: return "CAPTURE";
+    case DOCK_STATE_CONTROL: return "CONTROL";
+    case DOCK_STATE_LATCH: return "LATCH";
+    case DOCK_STATE_UNLATCH: return "UNLATCH";
+    case DOCK_STATE_ABORT: return "ABORT";
+    }
+
+    return "?";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a dock-gs recording");
+    parser.addHelpOption();
+    parser.addPositionalArgument("segment", "Any segment file of the recording");
+    parser.addOption({"speed", "Multiple of real time, 0 is as fast as possible", "x", "0"});
+    parser.addOption({"from", "Start at this many seconds into the recording", "s", "0"});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    ReplayEngine replay;
+
+    if (!replay.open(parser.positionalArguments().first()))
+    {
+        fprintf(stderr, "Failed to open %s\n", qPrintable(parser.positionalArguments().first()));
+        return 1;
+    }
+
+    const RecordingReader &rec = replay.recording();
+    out << QString::asprintf("%llu records, %.3f s", (unsigned long long)rec.count(), replay.duration_ns() * 1e-9) << Qt::endl;
+
+    // Nothing is plotted, the sessions only keep the link statistics
+    SessionManager sessions(nullptr, 1);
+    QHash<udp_endpoint_t, enum dock_state> states;
+
+    replay.set_sink([&](const telemetry_rx_t *frames, size_t n, int64_t now_ns) {
+        sessions.deliver(frames, n, now_ns);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            auto it = states.constFind(frames[i].src);
+
+            if (it == states.cend() || it.value() != frames[i].t.state)
+            {
+                out << QString::asprintf("%10.3f s  %-15s %s", frames[i].rx_ns * 1e-9,
+                                         qPrintable(udp_endpoint_address(frames[i].src).toString()), state_name(frames[i].t.state))
+                    << Qt::endl;
+                states.insert(frames[i].src, frames[i].t.state);
+            }
+        }
+    });
+
+    replay.seek(qint64(parser.value("from").toDouble() * 1e9));
+    replay.set_speed(parser.value("speed").toDouble());
+
+    QElapsedTimer wall;
+    wall.start();
+
+    if (replay.speed() > 0)
+    {
+        QObject::connect(&replay, &ReplayEngine::finished, &app, &QCoreApplication::quit);
+        replay.play();
+        app.exec();
+    }
+    else
+    {
+        replay.run();
+    }
+
+    const double seconds = wall.nsecsElapsed() * 1e-9;
+
+    out << Qt::endl;
+
+    for (SatelliteSession *s : sessions.all())
+    {
+        const link_stats_t &l = s->link();
+        const LatencyHistogram &j = s->arrival_jitter();
+
+        out << QString::asprintf("%-15s frames %llu, dropped %llu, jitter p50 %lld us, p99 %lld us, max %lld us",
+                                 qPrintable(s->name()), (unsigned long long)l.frames, (unsigned long long)l.dropped,
+                                 (long long)j.percentile(0.5), (long long)j.percentile(0.99), (long long)j.max())
+            << Qt::endl;
+    }
+
+    out << QString::asprintf("%llu frames, %llu corrupt, %llu CRC mismatch, %llu telecommands in %.3f s, %.0f frames/s",
+                             (unsigned long long)replay.frames(), (unsigned long long)replay.corrupt(),
+                             (unsigned long long)replay.crc_mismatches(),
+                             (unsigned long long)replay.sent(), seconds, replay.frames() / qMax(seconds, 1e-9))
+        << Qt::endl;
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include "replot_scheduler.h"
+#include "qcustomplot.h"
+#include "sat_config.h"
+
+// Share of the GUI thread the replots may take before the interval stretches
+#define REPLOT_LOAD_DIVISOR 4
+
+ReplotScheduler::ReplotScheduler(int interval_ms, int max_interval_ms, QObject *parent)
+    : QObject(parent)
+    , min_interval(interval_ms)
+    , max_interval(max_interval_ms)
+{
+    timer.setInterval(min_interval);
+
+    for (QSharedPointer<QCPGraphSpanDataSource> &source : channel_sources)
+    {
+        source.reset(new QCPGraphSpanDataSource);
+    }
+
+    connect(&timer, &QTimer::timeout, this, &ReplotScheduler::refresh);
+}
+
+void ReplotScheduler::add_source(QCustomPlot *plot, int graph, int channel)
+{
+    for (plot_entry_t &entry : plots)
+    {
+        if (entry.plot == plot)
+        {
+            entry.sources.append(plot_source_t{graph, channel});
+            set_live(entry, entry.live);
+            return;
+        }
+    }
+
+    plots.append(plot_entry_t{plot, {plot_source_t{graph, channel}}, 0, true, 0, 0, 0});
+    set_live(plots.last(), true);
+
+    // The store moves on between ticks, replots in between (resizes, the
+    // operator's clicks) must see its current window
+    connect(plot, &QCustomPlot::beforeReplot, this, &ReplotScheduler::update_sources);
+
+    // The operator dragging or zooming the time axis, rescaleAxes() is ours
+    connect(plot->xAxis, qOverload<const QCPRange &>(&QCPAxis::rangeChanged), this, [this, plot]()
+    {
+        plot_entry_t *entry = entry_of(plot);
+
+        if (rescaling || !entry || !history || !lod)
+        {
+            return;
+        }
+
+        if (entry->live)
+        {
+            set_live(*entry, false);
+        }
+
+        show_history(*entry);
+    });
+
+    connect(plot, &QCustomPlot::mouseDoubleClick, this, [this, plot]()
+    {
+        plot_entry_t *entry = entry_of(plot);
+
+        if (entry && !entry->live)
+        {
+            set_live(*entry, true);
+            refresh();
+        }
+    });
+}
+
+void ReplotScheduler::set_store(const TelemetryStore *s)
+{
+    store = s;
+    update_sources();
+
+    // A new session starts out live
+    for (plot_entry_t &entry : plots)
+    {
+        set_live(entry, true);
+    }
+}
+
+void ReplotScheduler::set_history(const TelemetryHistory *h, const TelemetryLod *l)
+{
+    history = h;
+    lod = l;
+}
+
+void ReplotScheduler::start()
+{
+    timer.start();
+}
+
+void ReplotScheduler::stop()
+{
+    timer.stop();
+}
+
+void ReplotScheduler::refresh()
+{
+    if (!store)
+    {
+        return;
+    }
+
+    update_sources();
+
+    const uint64_t total = store->total();
+    double replot_ms = 0;
+
+    for (plot_entry_t &entry : plots)
+    {
+        if (!on_screen(entry.plot))
+        {
+            continue;
+        }
+
+        // Last replot of this plot, averaged by QCustomPlot over recent ones
+        replot_ms += entry.plot->replotTime(true);
+
+        if (!entry.live)
+        {
+            // Redrawn when the view reaches the newest samples, or the
+            // session was cleared
+            if (history && lod && lod->size() != entry.shown_samples &&
+                (lod->size() < entry.shown_samples || entry.shown_to >= entry.shown_last))
+            {
+                show_history(entry);
+            }
+
+            continue;
+        }
+
+        // The graphs draw the store itself, hidden plots are up to date as
+        // soon as they are shown, and a cleared store is an empty plot
+        if (entry.plotted == total)
+        {
+            continue;
+        }
+
+        entry.plotted = total;
+
+        rescaling = true;
+        entry.plot->rescaleAxes();
+        rescaling = false;
+
+        entry.plot->replot(QCustomPlot::rpQueuedReplot);
+    }
+
+    int interval = qBound(min_interval, int(replot_ms * REPLOT_LOAD_DIVISOR), max_interval);
+
+    if (interval != timer.interval())
+    {
+        timer.setInterval(interval);
+    }
+}
+
+bool ReplotScheduler::on_screen(const QCustomPlot *plot)
+{
+    // Plots on hidden tabs are not visible, clipped or scrolled away ones
+    // have an empty visible region
+    return plot->isVisible() && !plot->window()->isMinimized() && !plot->visibleRegion().isEmpty();
+}
+
+void ReplotScheduler::clear_graphs(plot_entry_t &entry)
+{
+    // Only history plots hold samples of their own
+    for (const plot_source_t &src : entry.sources)
+    {
+        entry.plot->graph(src.graph)->data()->clear();
+    }
+
+    entry.plotted = 0;
+}
+
+ReplotScheduler::plot_entry_t *ReplotScheduler::entry_of(const QCustomPlot *plot)
+{
+    for (plot_entry_t &entry : plots)
+    {
+        if (entry.plot == plot)
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void ReplotScheduler::set_live(plot_entry_t &entry, bool live)
+{
+    entry.live = live;
+    entry.shown_samples = 0;
+
+    // Live graphs draw the store through the channel sources, history
+    // graphs their own data
+    for (const plot_source_t &src : entry.sources)
+    {
+        if (live)
+        {
+            entry.plot->graph(src.graph)->setDataSource(channel_sources[src.channel]);
+        }
+        else
+        {
+            entry.plot->graph(src.graph)->setDataSource(QSharedPointer<QCPGraphDataSource>());
+        }
+    }
+
+    // Live plots rescale on the next tick
+    clear_graphs(entry);
+}
+
+void ReplotScheduler::update_sources()
+{
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        if (!store)
+        {
+            channel_sources[ch]->clear();
+            continue;
+        }
+
+        const sample_span_t keys = store->keys();
+        const sample_span_t values = store->channel(ch);
+        double lower, upper;
+
+        channel_sources[ch]->setData(keys.data, values.data, int(keys.size));
+
+        // Tracked by the store, rescaleAxes() then doesn't scan the window
+        if (store->channel_range(ch, lower, upper))
+        {
+            channel_sources[ch]->setValueRange(true, QCPRange(lower, upper));
+        }
+        else
+        {
+            channel_sources[ch]->setValueRange(false);
+        }
+    }
+}
+
+void ReplotScheduler::show_history(plot_entry_t &entry)
+{
+    const QCPRange range = entry.plot->xAxis->range();
+    const int pixels = qMax(1, entry.plot->xAxis->axisRect()->width());
+    const int level = lod->level_for(range.lower, range.upper, pixels);
+
+    // Raw samples just outside the range, so the line runs to the border
+    const double margin = qMax(range.size() / pixels, 2 * THREAD_PERIOD_TELEM_MILLIS / 1000.0);
+
+    QVector<QCPGraphData> data;
+
+    for (const plot_source_t &src : entry.sources)
+    {
+        if (level < 0)
+        {
+            history->read(int64_t((range.lower - margin) * 1e9), int64_t((range.upper + margin) * 1e9), src.channel,
+                          history_keys, history_values);
+        }
+        else
+        {
+            lod->envelope(level, range.lower, range.upper, src.channel, history_keys, history_values);
+        }
+
+        data.resize(qsizetype(history_keys.size()));
+        for (size_t i = 0; i < history_keys.size(); i++)
+        {
+            data[qsizetype(i)] = QCPGraphData(history_keys[i], history_values[i]);
+        }
+
+        entry.plot->graph(src.graph)->data()->set(data, true);
+    }
+
+    // Fit the values of the visible range, the time axis stays as dragged
+    rescaling = true;
+    for (int i = 0; i < entry.sources.size(); i++)
+    {
+        entry.plot->graph(entry.sources[i].graph)->rescaleValueAxis(i > 0, true);
+    }
+    rescaling = false;
+
+    entry.shown_to = range.upper;
+    entry.shown_last = lod->last_key();
+    entry.shown_samples = lod->size();
+
+    entry.plot->replot(QCustomPlot::rpQueuedReplot);
+}
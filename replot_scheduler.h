@@ -0,0 +1,102 @@
+#ifndef REPLOT_SCHEDULER_H
+#define REPLOT_SCHEDULER_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <vector>
+
+#include "telemetry_history.h"
+#include "telemetry_lod.h"
+#include "telemetry_store.h"
+
+class QCustomPlot;
+class QCPGraphSpanDataSource;
+
+// Draws TelemetryStore columns in the registered plots and redraws them.
+// Live graphs of the same channel share one span data source over the store
+// column, the samples are never copied into the plots, and take the value
+// range the store tracks for autoscaling.
+// A tick only touches plots that are on screen and have new samples, redraws
+// are queued so they collapse into one paint, and the tick interval stretches
+// when the measured replot time grows.
+//
+// Dragging or zooming a plot's time axis leaves the live window: the plot then
+// shows the session's history for the visible range, from the min/max pyramid
+// when there are more samples than pixels and from the compressed samples
+// otherwise, so every redraw has a few points per pixel. A double click goes
+// back to live.
+class ReplotScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    ReplotScheduler(int interval_ms, int max_interval_ms, QObject *parent = nullptr);
+
+    // Feeds graph(graph) of plot from a store channel
+    void add_source(QCustomPlot *plot, int graph, int channel);
+
+    // Replaces the store the plots are fed from, the graphs start over
+    void set_store(const TelemetryStore *store);
+
+    // Sources of the plots that left the live window, of the same session
+    void set_history(const TelemetryHistory *history, const TelemetryLod *lod);
+
+    int interval() const { return timer.interval(); }
+
+public slots:
+    void start();
+
+    void stop();
+
+    // Updates the visible plots right away, e.g. after switching tabs
+    void refresh();
+
+private:
+    typedef struct
+    {
+        int graph;
+        int channel;
+    } plot_source_t;
+
+    typedef struct
+    {
+        QCustomPlot *plot;
+        QVector<plot_source_t> sources;
+        uint64_t plotted; // store->total() as of the last update of this plot
+        bool live;        // Following the store, or showing the history
+        double shown_to;  // End of the time range the history was drawn for,
+        double shown_last; // latest sample and samples at the time
+        uint64_t shown_samples;
+    } plot_entry_t;
+
+    static bool on_screen(const QCustomPlot *plot);
+
+    void clear_graphs(plot_entry_t &entry);
+
+    plot_entry_t *entry_of(const QCustomPlot *plot);
+
+    void set_live(plot_entry_t &entry, bool live);
+
+    // Points the channel sources at the current store window
+    void update_sources();
+
+    // Fills the graphs with the history of the visible time range
+    void show_history(plot_entry_t &entry);
+
+    QTimer timer;
+    QVector<plot_entry_t> plots;
+    const TelemetryStore *store = nullptr;
+    const TelemetryHistory *history = nullptr;
+    const TelemetryLod *lod = nullptr;
+    QSharedPointer<QCPGraphSpanDataSource> channel_sources[TELEM_CHANNELS];
+    bool rescaling = false; // Range changes of our own, not the operator's
+    std::vector<double> history_keys;
+    std::vector<double> history_values;
+    int min_interval;
+    int max_interval;
+};
+
+#endif // REPLOT_SCHEDULER_H
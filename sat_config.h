@@ -33,7 +33,7 @@
 #define TOF_RANGE_TIMEOUT_MILLIS 2
 
 // Buffer size
-#define MAX_BUFFER_SIZE_TCMD 25
+#define MAX_BUFFER_SIZE_TCMD 64 // Fits a batch of four coil set-points, 25 before batching
 #define MAX_BUFFER_SIZE_TELEM 200
 
 // ToF Kalman Filter parameters
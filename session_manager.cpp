@@ -0,0 +1,477 @@
+#include "session_manager.h"
+
+#include <QRandomGenerator>
+
+#include <limits>
+
+SatelliteSession::SatelliteSession(const QHostAddress &ip, quint16 port, UdpLink *link, size_t window, QObject *parent)
+    : QObject(parent)
+    , ip(ip)
+    , cmd_port(port)
+    , unit_name(ip.toString())
+    , udp_link(link)
+    , store(window)
+{
+    // The unit skips sequence numbers still in its history of executed
+    // commands, firmware that predates the reset on "Hello" keeps it across
+    // ground station restarts. Numbering from 1 every start would make it
+    // skip (and acknowledge) the first commands after a restart.
+    tcmd_seq = quint16(QRandomGenerator::global()->generate());
+
+    // Telecommands are paced on the event loop instead of sleeping
+    tcmd_clock.start();
+    timer_tcmd.setSingleShot(true);
+    connect(&timer_tcmd, &QTimer::timeout, this, &SatelliteSession::process_queue);
+
+    timer_tcmd_retx.setSingleShot(true);
+    connect(&timer_tcmd_retx, &QTimer::timeout, this, &SatelliteSession::retransmit);
+}
+
+void SatelliteSession::receive(const telemetry_rx_t &frame, int64_t now_ns)
+{
+    const int64_t period_ns = int64_t(THREAD_PERIOD_TELEM_MILLIS) * 1000000;
+
+    link_stats_frame(stats, frame.rx_ns / 1000000, frame.t.seq);
+
+    if (first_rx_ns < 0)
+    {
+        first_rx_ns = frame.rx_ns;
+    }
+    else
+    {
+        // Off the nearest multiple of the period, so lost frames don't count
+        // as jitter. Jitter beyond half a period aliases.
+        int64_t interval = frame.rx_ns - last_rx_ns;
+        int64_t deviation = interval - (interval + period_ns / 2) / period_ns * period_ns;
+
+        jitter_hist.record(qAbs(deviation) / 1000);
+    }
+
+    last_rx_ns = frame.rx_ns;
+    gs_delay_hist.record(qMax<int64_t>(0, now_ns - frame.rx_ns) / 1000);
+
+    const double key = (frame.rx_ns - first_rx_ns) * 1e-9;
+
+    store.append(key, frame.t);
+    hist.append(frame.rx_ns - first_rx_ns, frame.t);
+    hist_lod.append(key, frame.t);
+    last = frame.t;
+
+    // Log a missed deadline when the thread goes into alarm, not every frame
+    uint32_t alarms = threads.alarms();
+    uint32_t raised = threads.record(frame.t.dt) & ~alarms;
+
+    for (int i = 0; raised; i++, raised >>= 1)
+    {
+        if (raised & 1)
+        {
+            qDebug() << name() << fw_thread_name(fw_thread(i)) << "thread overran its" << fw_thread_period(fw_thread(i))
+                     << "ms period:" << frame.t.dt[i] << "ms";
+        }
+    }
+
+    if (frame.t.ack != 0)
+    {
+        acks_seen = true;
+        acks_unsupported = false;
+        handle_ack(frame.t.ack);
+    }
+}
+
+void SatelliteSession::clear_telemetry()
+{
+    last = {};
+    store.clear();
+    hist.clear();
+    hist_lod.clear();
+    first_rx_ns = -1;
+    last_rx_ns = -1;
+    stats = {0, 0, -1, -1};
+    jitter_hist.reset();
+    gs_delay_hist.reset();
+    threads.reset();
+}
+
+void SatelliteSession::send(const QByteArray &data)
+{
+    if (!udp_link)
+    {
+        // Replayed session
+        return;
+    }
+
+    UdpLink *link = udp_link;
+    QHostAddress dst = ip;
+    quint16 port = cmd_port;
+
+    QMetaObject::invokeMethod(udp_link, [=]() { link->send(data, dst, port); });
+}
+
+void SatelliteSession::send_raw(const QByteArray &data)
+{
+    send(data);
+}
+
+void SatelliteSession::bytes_written(qint64 bytes)
+{
+    if (!sending)
+    {
+        // Not a telecommand, e.g. the hello/bye datagrams
+        return;
+    }
+
+    sending = false;
+
+    if (bytes < 0)
+    {
+        qDebug() << "Failed to send telecommand" << tcmd_in_flight.params[0].idx << "to" << name();
+    }
+    else
+    {
+        tcmd_stats_t &s = tcmd_stats[tcmd_in_flight.params[0].idx];
+        qint64 latency = tcmd_clock.elapsed() - tcmd_in_flight.queued_ms;
+
+        s.count++;
+        s.last_ms = latency;
+        s.total_ms += latency;
+        s.max_ms = qMax(s.max_ms, latency);
+    }
+
+    process_queue();
+}
+
+void SatelliteSession::process_queue()
+{
+    if (sending)
+    {
+        return;
+    }
+
+    QQueue<tcmd_t> *lane = nullptr;
+
+    // Urgent commands jump the queue but are paced as well, the firmware
+    // executes one datagram per TCMD cycle
+    if (!queue[TCMD_LANE_URGENT].isEmpty())
+    {
+        lane = &queue[TCMD_LANE_URGENT];
+    }
+    else if (!queue[TCMD_LANE_NORMAL].isEmpty())
+    {
+        lane = &queue[TCMD_LANE_NORMAL];
+    }
+    else
+    {
+        return;
+    }
+
+    qint64 wait = tcmd_last_sent_ms + pacing - tcmd_clock.elapsed();
+    if (tcmd_last_sent_ms >= 0 && wait > 0)
+    {
+        timer_tcmd.start(wait);
+        return;
+    }
+
+    sending = true;
+    tcmd_in_flight = lane->dequeue();
+    tcmd_last_sent_ms = tcmd_clock.elapsed();
+
+    // Retransmissions keep their sequence number
+    if (tcmd_in_flight.seq == 0)
+    {
+        if (++tcmd_seq == 0)
+        {
+            tcmd_seq = 1;
+        }
+
+        tcmd_in_flight.seq = tcmd_seq;
+        tcmd_in_flight.sent_us = tcmd_clock.nsecsElapsed() / 1000;
+    }
+
+    tcmd_in_flight.attempts++;
+
+    if (acks_unsupported)
+    {
+        // Firmware without acks, sent once
+        tcmd_unacked++;
+    }
+    else
+    {
+        tcmd_in_flight.deadline_ms = tcmd_last_sent_ms + (qint64(TCMD_ACK_TIMEOUT_MILLIS) << (tcmd_in_flight.attempts - 1));
+        tcmd_in_flight.frames = stats.frames;
+        tcmd_pending.insert(tcmd_in_flight.seq, tcmd_in_flight);
+        schedule_retransmit();
+    }
+
+    QByteArray formatted = format_tcmd(tcmd_in_flight);
+    qDebug() << name() << formatted;
+
+    send(formatted);
+}
+
+// The firmware echoes only the sequence number of the last command it
+// executed. When the telemetry frames carrying one echo are all lost before
+// the next command executes, the earlier command is never acknowledged and
+// is retransmitted; the firmware then only acknowledges it again, and Karn's
+// rule keeps it out of the round-trip times. The echo is not taken as
+// cumulative: the firmware executes retransmissions out of order, so a lower
+// pending sequence number may be a datagram that was lost on the way up.
+void SatelliteSession::handle_ack(quint16 seq)
+{
+    auto it = tcmd_pending.find(seq);
+
+    if (it == tcmd_pending.end())
+    {
+        // Acknowledged while waiting for retransmission, or a repeated echo
+        for (QQueue<tcmd_t> &lane : queue)
+        {
+            lane.removeIf([seq](const tcmd_t &cmd) { return cmd.seq == seq; });
+        }
+        return;
+    }
+
+    const tcmd_t cmd = it.value();
+    tcmd_pending.erase(it);
+    tcmd_acked++;
+    tcmd_last_acked = cmd.params[0].idx;
+
+    // Retransmitted commands give ambiguous round-trip times (Karn)
+    if (cmd.attempts == 1)
+    {
+        qint64 rtt = tcmd_clock.nsecsElapsed() / 1000 - cmd.sent_us;
+        rtt_hist[cmd.params[0].idx].record(rtt);
+        rtt_all.record(rtt);
+    }
+}
+
+void SatelliteSession::retransmit()
+{
+    qint64 now = tcmd_clock.elapsed();
+
+    for (auto it = tcmd_pending.begin(); it != tcmd_pending.end();)
+    {
+        if (it->deadline_ms > now)
+        {
+            ++it;
+            continue;
+        }
+
+        if (!acks_seen && it->attempts >= TCMD_ACK_PROBE_ATTEMPTS && stats.frames > it->frames)
+        {
+            // Telemetry arrives but never echoes anything, retransmitting
+            // every command up to the limit would only repeat it
+            if (!acks_unsupported)
+            {
+                qDebug() << name() << "does not acknowledge telecommands, sending them once";
+                acks_unsupported = true;
+            }
+
+            tcmd_unacked++;
+        }
+        else if (it->attempts >= TCMD_MAX_ATTEMPTS)
+        {
+            qDebug() << "Telecommand" << it->params[0].idx << "seq" << it->seq << "to" << name() << "not acknowledged, giving up";
+            tcmd_lost++;
+        }
+        else
+        {
+            tcmd_retransmits++;
+            queue[it->lane].prepend(it.value());
+        }
+
+        it = tcmd_pending.erase(it);
+    }
+
+    schedule_retransmit();
+    process_queue();
+}
+
+void SatelliteSession::schedule_retransmit()
+{
+    if (tcmd_pending.isEmpty())
+    {
+        timer_tcmd_retx.stop();
+        return;
+    }
+
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (const tcmd_t &cmd : std::as_const(tcmd_pending))
+    {
+        deadline = qMin(deadline, cmd.deadline_ms);
+    }
+
+    timer_tcmd_retx.start(qMax<qint64>(0, deadline - tcmd_clock.elapsed()));
+}
+
+void SatelliteSession::enqueue(const tcmd_param_t *params, int count)
+{
+    // Firmware that parses ';' batches also echoes sequence numbers. Until the
+    // unit has echoed one it may have the old 25-byte buffer, which would
+    // reject the batch, so the parameters go one per datagram.
+    if (count > 1 && !acks_seen)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            enqueue(&params[i], 1);
+        }
+        return;
+    }
+
+    tcmd_t cmd = {};
+
+    cmd.lane = TCMD_LANE_NORMAL;
+    cmd.queued_ms = tcmd_clock.elapsed();
+
+    for (int i = 0; i < count; i++)
+    {
+        cmd.params[cmd.count++] = params[i];
+
+        if (tcmd_lane_of(params[i].idx) == TCMD_LANE_URGENT)
+        {
+            cmd.lane = TCMD_LANE_URGENT;
+        }
+    }
+
+    queue[cmd.lane].enqueue(cmd);
+    process_queue();
+}
+
+SessionManager::SessionManager(UdpLink *link, size_t window, QObject *parent)
+    : QObject(parent)
+    , udp_link(link)
+    , window(window)
+{
+    if (udp_link)
+    {
+        connect(udp_link, &UdpLink::bytesWritten, this, &SessionManager::bytes_written);
+    }
+}
+
+SatelliteSession *SessionManager::add(const QHostAddress &ip, quint16 port)
+{
+    SatelliteSession *session = find(ip);
+
+    if (session)
+    {
+        session->set_port(port);
+        return session;
+    }
+
+    // Keyed on its sender port with the first frame, see deliver()
+    return create(udp_endpoint(ip, 0), port);
+}
+
+SatelliteSession *SessionManager::create(const udp_endpoint_t &sender, quint16 port)
+{
+    const QHostAddress ip = udp_endpoint_address(sender);
+    SatelliteSession *session = new SatelliteSession(ip, port, udp_link, window, this);
+    session->set_pacing(pacing);
+
+    // Further units behind the same address go by address and port
+    if (find(ip))
+    {
+        session->set_name(QString("%1:%2").arg(ip.toString()).arg(sender.port));
+    }
+
+    by_sender.insert(sender, session);
+    sessions.append(session);
+
+    emit sessionAdded(session);
+    return session;
+}
+
+SatelliteSession *SessionManager::find(const QHostAddress &ip) const
+{
+    for (SatelliteSession *session : sessions)
+    {
+        if (session->address().isEqual(ip, QHostAddress::TolerantConversion))
+        {
+            return session;
+        }
+    }
+
+    return nullptr;
+}
+
+void SessionManager::set_pacing(int ms)
+{
+    pacing = ms;
+
+    for (SatelliteSession *session : std::as_const(sessions))
+    {
+        session->set_pacing(ms);
+    }
+}
+
+size_t SessionManager::dispatch()
+{
+    telemetry_rx_t batch[64];
+    size_t n;
+    size_t total = 0;
+
+    if (!udp_link)
+    {
+        return 0;
+    }
+
+    while ((n = udp_link->drain(batch, 64)) > 0)
+    {
+        deliver(batch, n, udp_link->now_ns());
+        total += n;
+    }
+
+    return total;
+}
+
+void SessionManager::deliver(const telemetry_rx_t *frames, size_t n, int64_t now_ns)
+{
+    // Frames of one unit usually come in runs, skip the lookup for those
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!last || frames[i].src != last_sender)
+        {
+            last_sender = frames[i].src;
+            last = by_sender.value(last_sender, nullptr);
+
+            if (!last)
+            {
+                udp_endpoint_t added = last_sender;
+                added.port = 0;
+
+                // Added explicitly and now heard from for the first time
+                last = by_sender.take(added);
+
+                if (last)
+                {
+                    by_sender.insert(last_sender, last);
+                }
+                else
+                {
+                    last = create(last_sender, cmd_port);
+                }
+            }
+        }
+
+        last->receive(frames[i], now_ns);
+    }
+}
+
+void SessionManager::clear_telemetry()
+{
+    for (SatelliteSession *session : std::as_const(sessions))
+    {
+        session->clear_telemetry();
+    }
+}
+
+void SessionManager::bytes_written(qint64 bytes, const QHostAddress &ip, quint16 port)
+{
+    // Units behind one address are told apart by their telecommand port
+    for (SatelliteSession *session : std::as_const(sessions))
+    {
+        if (session->awaiting_write() && session->port() == port && session->address() == ip)
+        {
+            session->bytes_written(bytes);
+            return;
+        }
+    }
+}
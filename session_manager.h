@@ -0,0 +1,212 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QQueue>
+#include <QTimer>
+#include <QVector>
+
+#include "latency_histogram.h"
+#include "telecommand.h"
+#include "telemetry.h"
+#include "telemetry_history.h"
+#include "telemetry_lod.h"
+#include "telemetry_store.h"
+#include "thread_monitor.h"
+#include "udp_link.h"
+
+// State of one satellite on the link: its telemetry, telecommand queue and
+// link statistics. Lives on the GUI thread, sends through the UdpLink.
+class SatelliteSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    SatelliteSession(const QHostAddress &ip, quint16 port, UdpLink *link, size_t window, QObject *parent = nullptr);
+
+    QHostAddress address() const { return ip; }
+    quint16 port() const { return cmd_port; }
+    QString name() const { return unit_name; }
+
+    void set_port(quint16 port) { cmd_port = port; }
+
+    // Set by the SessionManager for units sharing an address
+    void set_name(const QString &name) { unit_name = name; }
+
+    // Telemetry, now_ns is the current time on the link clock
+    void receive(const telemetry_rx_t &frame, int64_t now_ns);
+
+    // Drops the telemetry and link statistics, e.g. when a replay seeks
+    void clear_telemetry();
+
+    const telemetry_t &last_telemetry() const { return last; }
+    const TelemetryStore &telemetry() const { return store; }
+
+    // Every sample since the session started, compressed, keys on the same
+    // axis as telemetry()
+    const TelemetryHistory &history() const { return hist; }
+
+    // Min/max pyramid over history(), for plots zoomed out over it
+    const TelemetryLod &lod() const { return hist_lod; }
+    const link_stats_t &link() const { return stats; }
+
+    // Deviation [us] of the kernel inter-arrival times from the telemetry
+    // period, i.e. scheduling on the satellite plus the network
+    const LatencyHistogram &arrival_jitter() const { return jitter_hist; }
+
+    // Time [us] from the kernel receiving a frame until the GUI handles it,
+    // i.e. scheduling on the ground station
+    const LatencyHistogram &gs_delay() const { return gs_delay_hist; }
+
+    // Periods the firmware threads report in dt[]
+    const ThreadMonitor &thread_health() const { return threads; }
+
+    // Telecommands, the parameters of one call are applied together once the
+    // unit has shown it takes batches, see batching()
+    void enqueue(const tcmd_param_t *params, int count);
+
+    // The unit echoed a sequence number, so it has the firmware that parses
+    // batches of parameters
+    bool batching() const { return acks_seen; }
+
+    // Untracked datagram, e.g. the hello/bye messages
+    void send_raw(const QByteArray &data);
+
+    // Gap between telecommands of either lane
+    void set_pacing(int ms) { pacing = ms; }
+
+    // Result of the last datagram written to this unit
+    void bytes_written(qint64 bytes);
+
+    // A telecommand is on its way to the link, see bytes_written()
+    bool awaiting_write() const { return sending; }
+
+    const tcmd_t &in_flight() const { return tcmd_in_flight; }
+    int queued() const { return queue[TCMD_LANE_URGENT].size() + queue[TCMD_LANE_NORMAL].size(); }
+    int pending() const { return tcmd_pending.size(); }
+    const tcmd_stats_t &stats_of(enum tcmd_idx idx) const { return tcmd_stats[idx]; }
+    quint64 acked() const { return tcmd_acked; }
+    quint64 retransmits() const { return tcmd_retransmits; }
+    quint64 lost() const { return tcmd_lost; }
+
+    // Telecommands sent once and not tracked, the unit never acknowledges
+    quint64 unacknowledged() const { return tcmd_unacked; }
+    bool acks_supported() const { return !acks_unsupported; }
+    int last_acked() const { return tcmd_last_acked; }
+
+    // Round-trip time [us] per command type and over all commands
+    const LatencyHistogram &rtt(enum tcmd_idx idx) const { return rtt_hist[idx]; }
+    const LatencyHistogram &rtt() const { return rtt_all; }
+
+private:
+    void process_queue();
+
+    void handle_ack(quint16 seq);
+
+    void retransmit();
+
+    void schedule_retransmit();
+
+    void send(const QByteArray &data);
+
+    QHostAddress ip;
+    quint16 cmd_port;
+    QString unit_name;
+    UdpLink *udp_link;
+
+    telemetry_t last = {};
+    TelemetryStore store;
+    TelemetryHistory hist;
+    TelemetryLod hist_lod;
+    int64_t first_rx_ns = -1; // Zero of the plots' time axis
+    int64_t last_rx_ns = -1;
+    link_stats_t stats = {0, 0, -1, -1};
+    LatencyHistogram jitter_hist;
+    LatencyHistogram gs_delay_hist;
+    ThreadMonitor threads;
+
+    QQueue<tcmd_t> queue[TCMD_LANES];
+    tcmd_t tcmd_in_flight = {};
+    bool sending = false;
+    int pacing = TCMD_PACING_MILLIS;
+    QTimer timer_tcmd;
+    QElapsedTimer tcmd_clock;
+    qint64 tcmd_last_sent_ms = -1;
+    tcmd_stats_t tcmd_stats[TCMD_LENGTH] = {};
+
+    // Sent but not yet acknowledged, by sequence number
+    QHash<quint16, tcmd_t> tcmd_pending;
+    quint16 tcmd_seq; // Last one used, starts at random, see the constructor
+    QTimer timer_tcmd_retx;
+    quint64 tcmd_acked = 0;
+    quint64 tcmd_retransmits = 0;
+    quint64 tcmd_lost = 0;
+    quint64 tcmd_unacked = 0;
+    bool acks_seen = false;        // The unit echoed a sequence number
+    bool acks_unsupported = false; // Telemetry but no echo, see retransmit()
+    int tcmd_last_acked = TCMD_LENGTH;
+
+    LatencyHistogram rtt_hist[TCMD_LENGTH];
+    LatencyHistogram rtt_all;
+};
+
+// Demultiplexes the frames of the UdpLink by sender address and port, one
+// session per satellite, so several units behind one address stay apart.
+// Units not added explicitly get a session with their first frame, units
+// added explicitly take the port their first frame comes from. Without a link
+// the sessions only take delivered frames, e.g. from a replay.
+class SessionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    SessionManager(UdpLink *link, size_t window, QObject *parent = nullptr);
+
+    // Session of the unit at ip, created if needed. port is the telecommand
+    // port, the unit may send its telemetry from any port.
+    SatelliteSession *add(const QHostAddress &ip, quint16 port);
+
+    // First session at ip, whatever port it sends from
+    SatelliteSession *find(const QHostAddress &ip) const;
+
+    const QVector<SatelliteSession *> &all() const { return sessions; }
+
+    // Telecommand port of units that show up by their telemetry
+    void set_port(quint16 port) { cmd_port = port; }
+
+    void set_pacing(int ms);
+
+    // Drains the link into the sessions, returns the number of frames
+    size_t dispatch();
+
+    // Hands frames to the sessions of their senders, now_ns is the current
+    // time on the clock the frames were stamped with
+    void deliver(const telemetry_rx_t *frames, size_t n, int64_t now_ns);
+
+    void clear_telemetry();
+
+signals:
+    void sessionAdded(SatelliteSession *session);
+
+private slots:
+    void bytes_written(qint64 bytes, const QHostAddress &ip, quint16 port);
+
+private:
+    SatelliteSession *create(const udp_endpoint_t &sender, quint16 port);
+
+    UdpLink *udp_link;
+    size_t window;
+    quint16 cmd_port = 0;
+    int pacing = TCMD_PACING_MILLIS;
+
+    // By telemetry sender, port 0 for units added before their first frame
+    QHash<udp_endpoint_t, SatelliteSession *> by_sender;
+    QVector<SatelliteSession *> sessions;
+    udp_endpoint_t last_sender = {};
+    SatelliteSession *last = nullptr;
+};
+
+#endif // SESSION_MANAGER_H
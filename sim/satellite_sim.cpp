@@ -0,0 +1,490 @@
+#include "satellite_sim.h"
+
+#include <QDebug>
+#include <QNetworkDatagram>
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// Force between the coils of both satellites [N] per A^2 at 1 m, u0 N^2 A / 2
+static const double coil_force_constant = COIL_PARAM_u0 * COIL_PARAM_N * COIL_PARAM_N * COIL_PARAM_A / 2;
+
+SatelliteSim::SatelliteSim(const QHostAddress &address, quint16 port, QObject *parent)
+    : QObject(parent)
+    , address(address)
+    , port(port)
+    , rng(QRandomGenerator::global()->generate())
+{
+    connect(&socket, &QUdpSocket::readyRead, this, &SatelliteSim::read_datagrams);
+}
+
+bool SatelliteSim::start()
+{
+    if (!socket.bind(address, port))
+    {
+        qDebug() << "Failed to bind" << name() << socket.errorString();
+        return false;
+    }
+
+    // Threads start staggered like on the firmware
+    start_thread(timers[THREAD_TCMD], THREAD_TCMD, THREAD_PERIOD_TCMD_MILLIS, &SatelliteSim::tcmd_step);
+    start_thread(timers[THREAD_COIL], THREAD_COIL, THREAD_PERIOD_COIL_MILLIS, &SatelliteSim::coil_step);
+    start_thread(timers[THREAD_DOCK], THREAD_DOCK, THREAD_PERIOD_DOCK_MILLIS, &SatelliteSim::dock_step);
+    start_thread(timers[THREAD_RANGE], THREAD_RANGE, THREAD_PERIOD_RANGE_MILLIS, &SatelliteSim::range_step);
+    start_thread(timers[THREAD_TELEM], THREAD_TELEM, THREAD_PERIOD_TELEM_MILLIS, &SatelliteSim::telem_step);
+
+    return true;
+}
+
+void SatelliteSim::set_ground_station(const QHostAddress &ip, quint16 port)
+{
+    gs_ip = ip;
+    gs_port = port;
+}
+
+void SatelliteSim::start_thread(QTimer &timer, enum thread_idx thread, int period_ms, void (SatelliteSim::*step)())
+{
+    static const int start_ms[THREADS] = {THREAD_START_DOCK_MILLIS, THREAD_START_COIL_MILLIS, THREAD_START_TELEM_MILLIS,
+                                          THREAD_START_TCMD_MILLIS, THREAD_START_RANGE_MILLIS};
+
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, step);
+
+    QTimer::singleShot(start_ms[thread], this, [this, &timer, thread, period_ms]() {
+        clocks[thread].start();
+        timer.start(period_ms);
+    });
+}
+
+double SatelliteSim::period(enum thread_idx thread)
+{
+    double s = clocks[thread].nsecsElapsed() * 1e-9;
+
+    clocks[thread].restart();
+    dt[thread] = float(s * 1000);
+
+    return s;
+}
+
+void SatelliteSim::read_datagrams()
+{
+    while (socket.hasPendingDatagrams())
+    {
+        // Longer datagrams do not fit the firmware's buffer either
+        QNetworkDatagram datagram = socket.receiveDatagram(MAX_BUFFER_SIZE_TCMD);
+        QByteArray data = datagram.data();
+
+        gs_ip = datagram.senderAddress();
+        gs_port = quint16(datagram.senderPort());
+
+        if (data.startsWith("Hello"))
+        {
+            // A (re)started ground station numbers its commands anew, the
+            // old sequence numbers must not make them look like retransmissions
+            std::fill(std::begin(seq_history), std::end(seq_history), 0);
+            seq_next = 0;
+            ack = 0;
+
+            qDebug() << name() << "ground station at" << gs_ip.toString() << gs_port;
+            continue;
+        }
+
+        if (data.startsWith("Bye"))
+        {
+            gs_port = 0;
+            continue;
+        }
+
+        tcmd_t cmd = {};
+
+        if (!parse_tcmd(data, cmd) || tcmd_count == SIM_TCMD_QUEUE)
+        {
+            invalid++;
+            continue;
+        }
+
+        tcmd_queue[(tcmd_head + tcmd_count) % SIM_TCMD_QUEUE] = cmd;
+        tcmd_count++;
+    }
+}
+
+void SatelliteSim::tcmd_step()
+{
+    period(THREAD_TCMD);
+
+    if (tcmd_count == 0)
+    {
+        return;
+    }
+
+    const tcmd_t cmd = tcmd_queue[tcmd_head];
+    tcmd_head = (tcmd_head + 1) % SIM_TCMD_QUEUE;
+    tcmd_count--;
+
+    // A retransmission of a command that was executed, only acknowledge it
+    if (cmd.seq != 0 && std::find(std::begin(seq_history), std::end(seq_history), cmd.seq) != std::end(seq_history))
+    {
+        duplicates++;
+        ack = cmd.seq;
+        return;
+    }
+
+    // All parameters of a datagram take effect in the same cycle
+    for (int i = 0; i < cmd.count; i++)
+    {
+        apply(cmd.params[i]);
+    }
+
+    executed++;
+
+    if (cmd.seq != 0)
+    {
+        seq_history[seq_next] = cmd.seq;
+        seq_next = (seq_next + 1) % SIM_TCMD_SEQ_HISTORY;
+        ack = cmd.seq;
+    }
+}
+
+void SatelliteSim::apply(const tcmd_param_t &param)
+{
+    const double v = param.value;
+
+    switch (param.idx)
+    {
+    case TCMD_EM_KP: em_kp = v; break;
+    case TCMD_EM_KI: em_ki = v; break;
+
+    case TCMD_EM0:
+    case TCMD_EM1:
+    case TCMD_EM2:
+    case TCMD_EM3:
+        coils[param.idx - TCMD_EM0].sp_mA = v;
+        coils[param.idx - TCMD_EM0].stopped = false;
+        break;
+
+    case TCMD_EM0_STOP:
+    case TCMD_EM1_STOP:
+    case TCMD_EM2_STOP:
+    case TCMD_EM3_STOP:
+        coils[param.idx - TCMD_EM0_STOP].stopped = true;
+        break;
+
+    case TCMD_EM_STOP_ALL:
+        for (coil_t &coil : coils)
+        {
+            coil.stopped = true;
+        }
+        break;
+
+    case TCMD_KF_R: kf_r = v; break;
+    case TCMD_KF_Q00: kf_q00 = v; break;
+    case TCMD_KF_Q11: kf_q11 = v; break;
+
+    case TCMD_DOCK_KP: dock_kp = v; break;
+    case TCMD_DOCK_KI: dock_ki = v; break;
+    case TCMD_DOCK_KD: dock_kd = v; break;
+    case TCMD_DOCK_KF: dock_kf = v; break;
+    case TCMD_DOCK_LATCH_CURRENT: latch_mA = v; break;
+    case TCMD_DOCK_UNLATCH_CURRENT: unlatch_mA = v; break;
+    case TCMD_DOCK_VELOCITY_SP: velocity_sp = v; break;
+    case TCMD_DOCK_DISTANCE_SP: distance_sp = v; break;
+
+    case TCMD_DOCK_STATE_START: set_state(DOCK_STATE_START); break;
+    case TCMD_DOCK_STATE_IDLE: set_state(DOCK_STATE_IDLE); break;
+    case TCMD_DOCK_STATE_LATCH: set_state(DOCK_STATE_LATCH); break;
+    case TCMD_DOCK_STATE_ABORT: set_state(DOCK_STATE_ABORT); break;
+    case TCMD_DOCK_STATE_CAPTURE: set_state(DOCK_STATE_CAPTURE); break;
+    case TCMD_DOCK_STATE_CONTROL: set_state(DOCK_STATE_CONTROL); break;
+    case TCMD_DOCK_STATE_UNLATCH: set_state(DOCK_STATE_UNLATCH); break;
+
+    case TCMD_LENGTH:
+        break;
+    }
+}
+
+void SatelliteSim::set_state(enum dock_state state)
+{
+    if (state != dock)
+    {
+        qDebug() << name() << "state" << dock << "->" << state;
+    }
+
+    dock = state;
+    dock_integral = 0;
+
+    switch (state)
+    {
+    case DOCK_STATE_IDLE:
+    case DOCK_STATE_ABORT:
+        set_coils(0);
+        break;
+    case DOCK_STATE_UNLATCH:
+        latched = false;
+        break;
+    default:
+        break;
+    }
+}
+
+void SatelliteSim::set_coils(double mA)
+{
+    for (coil_t &coil : coils)
+    {
+        coil.sp_mA = mA;
+        coil.stopped = false;
+    }
+}
+
+void SatelliteSim::coil_step()
+{
+    const double dt = period(THREAD_COIL);
+    const double lag = 1 - std::exp(-dt * 1000 / SIM_COIL_TAU_MILLIS);
+    const double g = (gap_mm + SIM_COIL_OFFSET_MM) / 1000;
+    double force = 0;
+
+    for (coil_t &coil : coils)
+    {
+        const double target = coil.stopped ? 0 : coil.sp_mA;
+        const double dir = target < 0 ? -1 : 1;
+        double u = 0;
+
+        // PI on the magnitude, the H-bridge sets the direction
+        if (target == 0)
+        {
+            coil.integral = 0;
+        }
+        else
+        {
+            double e = std::fabs(target) - coil.i_mA * dir;
+
+            coil.integral += e * dt;
+
+            if (em_ki > 0)
+            {
+                coil.integral = qBound(PID_COIL_UMIN / em_ki, coil.integral, PID_COIL_UMAX / em_ki);
+            }
+
+            u = qBound(double(PID_COIL_UMIN), em_kp * e + em_ki * coil.integral, double(PID_COIL_UMAX));
+        }
+
+        coil.i_mA += (dir * u / 100 * SIM_COIL_FULL_SCALE_mA - coil.i_mA) * lag;
+
+        // The mate holds its polarity, positive currents attract
+        const double i_A = coil.i_mA / 1000;
+        force += (i_A < 0 ? -1 : 1) * coil_force_constant * i_A * i_A / (g * g);
+    }
+
+    if (latched)
+    {
+        return;
+    }
+
+    const double accel = force / SIM_MASS_KG * 1000; // [mm/s^2] closing
+
+    gap_rate += (-accel - SIM_DAMPING * gap_rate) * dt;
+    gap_mm += gap_rate * dt;
+
+    if (gap_mm <= 0)
+    {
+        gap_mm = 0;
+        gap_rate = qMax(0.0, gap_rate);
+
+        if (dock == DOCK_STATE_LATCH)
+        {
+            latched = true;
+        }
+    }
+}
+
+void SatelliteSim::range_step()
+{
+    const double dt = period(THREAD_RANGE);
+
+    for (int i = 0; i < 4; i++)
+    {
+        tof[i] = float(qBound(double(TOF_MIN_LENGTH_MM), gap_mm + tof_noise(rng), double(TOF_MAX_LENGTH_MM)));
+        kf_step(kf[i], tof[i], dt);
+    }
+}
+
+void SatelliteSim::kf_step(kf1d_t &f, double z, double dt)
+{
+    if (!f.valid)
+    {
+        f = {z, 0, {{kf_r, 0}, {0, kf_r}}, 0, true};
+        return;
+    }
+
+    // Predict, constant velocity
+    f.d += f.v * dt;
+    f.p[0][0] += dt * (f.p[1][0] + f.p[0][1]) + dt * dt * f.p[1][1] + kf_q00;
+    f.p[0][1] += dt * f.p[1][1];
+    f.p[1][0] += dt * f.p[1][1];
+    f.p[1][1] += kf_q11;
+
+    // Measurements far off the prediction are skipped, too many in a row
+    // restart the filter
+    const double y = z - f.d;
+    const double s = f.p[0][0] + kf_r;
+
+    if (std::fabs(y) > KF1D_MAX_TOF_ERROR * std::sqrt(s))
+    {
+        if (++f.rejected > KF1D_MAX_TOF_ERROR)
+        {
+            f.valid = false;
+        }
+        return;
+    }
+
+    const double k0 = f.p[0][0] / s;
+    const double k1 = f.p[1][0] / s;
+    const double p00 = f.p[0][0];
+    const double p01 = f.p[0][1];
+
+    f.rejected = 0;
+    f.d += k0 * y;
+    f.v += k1 * y;
+    f.p[0][0] -= k0 * p00;
+    f.p[0][1] -= k0 * p01;
+    f.p[1][0] -= k1 * p00;
+    f.p[1][1] -= k1 * p01;
+}
+
+double SatelliteSim::mean_distance() const
+{
+    return (kf[0].d + kf[1].d + kf[2].d + kf[3].d) / 4;
+}
+
+double SatelliteSim::mean_velocity() const
+{
+    return (kf[0].v + kf[1].v + kf[2].v + kf[3].v) / 4;
+}
+
+void SatelliteSim::dock_step()
+{
+    const double dt = period(THREAD_DOCK);
+    const double d = mean_distance();
+    const double v = mean_velocity();
+
+    switch (dock)
+    {
+    case DOCK_STATE_START:
+        set_state(DOCK_STATE_CAPTURE);
+        break;
+
+    case DOCK_STATE_IDLE:
+    case DOCK_STATE_ABORT:
+        break;
+
+    case DOCK_STATE_CAPTURE:
+        set_coils(DOCK_CAPTURE_CURRENT_mA);
+
+        if (d < SIM_CAPTURE_RANGE_MM)
+        {
+            set_state(DOCK_STATE_CONTROL);
+        }
+        break;
+
+    case DOCK_STATE_CONTROL:
+    {
+        if (std::fabs(v) > SIM_ABORT_SPEED_MM_S)
+        {
+            set_state(DOCK_STATE_ABORT);
+            break;
+        }
+
+        if (std::fabs(d - distance_sp) < SIM_LATCH_TOLERANCE_MM && std::fabs(v) < SIM_LATCH_SPEED_MM_S)
+        {
+            set_state(DOCK_STATE_LATCH);
+            break;
+        }
+
+        // PID on the distance [m] and velocity [m/s] to a coil current [A],
+        // KF scales the output
+        const double e = (d - distance_sp) / 1000;
+        const double i_max = DOCK_CAPTURE_CURRENT_mA / 1000.0;
+
+        dock_integral += e * dt;
+
+        if (dock_ki > 0)
+        {
+            dock_integral = qBound(-i_max / dock_ki, dock_integral, i_max / dock_ki);
+        }
+
+        const double i_A = dock_kp * e + dock_ki * dock_integral + dock_kd * (v - velocity_sp) / 1000;
+
+        set_coils(qBound(-double(DOCK_CAPTURE_CURRENT_mA), dock_kf * i_A * 1000, double(DOCK_CAPTURE_CURRENT_mA)));
+        break;
+    }
+
+    case DOCK_STATE_LATCH:
+        set_coils(latch_mA);
+
+        if (latched)
+        {
+            set_state(DOCK_STATE_IDLE);
+        }
+        break;
+
+    case DOCK_STATE_UNLATCH:
+        set_coils(unlatch_mA);
+
+        if (d > SIM_UNLATCH_DISTANCE_MM)
+        {
+            set_state(DOCK_STATE_IDLE);
+        }
+        break;
+    }
+}
+
+void SatelliteSim::telem_step()
+{
+    period(THREAD_TELEM);
+
+    if (gs_port == 0)
+    {
+        return;
+    }
+
+    telemetry_t t = {};
+
+    for (int i = 0; i < 4; i++)
+    {
+        t.d[i] = tof[i];
+        t.c[i] = float(coils[i].i_mA);
+        t.kf_d[i] = float(kf[i].d);
+        t.kf_v[i] = float(kf[i].v);
+    }
+
+    for (int i = 0; i < THREADS; i++)
+    {
+        t.dt[i] = dt[i];
+    }
+
+    t.state = dock;
+    t.ack = ack;
+
+    const quint16 seq = frame_seq++;
+
+    if (loss > 0 && QRandomGenerator::global()->generateDouble() < loss)
+    {
+        return;
+    }
+
+    QByteArray frame;
+
+    if (binary_frames)
+    {
+        frame.resize(sizeof(telemetry_frame_t));
+        frame.resize(encode_telemetry_frame(t, seq, frame.data(), frame.size()));
+    }
+    else
+    {
+        frame = format_telemetry(t);
+    }
+
+    socket.writeDatagram(frame, gs_ip, gs_port);
+    frames++;
+}
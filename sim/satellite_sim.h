@@ -0,0 +1,189 @@
+#ifndef SATELLITE_SIM_H
+#define SATELLITE_SIM_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <random>
+
+#include "sat_config.h"
+#include "telecommand.h"
+#include "telemetry.h"
+
+// Simulated mechanics, the gap is between the docking faces of this unit and
+// its (simulated) mate, which mirrors the coil currents
+#define SIM_INITIAL_GAP_MM 250.0
+#define SIM_MASS_KG 5.0               // Reduced mass of the two satellites
+#define SIM_DAMPING 0.5               // Air bearing drag [1/s]
+#define SIM_COIL_OFFSET_MM 30.0       // Coil behind the docking face
+#define SIM_COIL_FULL_SCALE_mA 3000.0 // Coil current at 100 % PWM
+#define SIM_COIL_TAU_MILLIS 10.0      // Coil current time constant
+#define SIM_TOF_NOISE_MM 1.0          // ToF standard deviation, matches KF1D_R
+
+// Docking sequence
+#define SIM_CAPTURE_RANGE_MM 120.0       // CAPTURE hands over to CONTROL below
+#define SIM_LATCH_TOLERANCE_MM 3.0       // CONTROL latches within this of the set-point
+#define SIM_LATCH_SPEED_MM_S 5.0         // ... when slower than this
+#define SIM_ABORT_SPEED_MM_S 150.0       // CONTROL aborts when faster than this
+#define SIM_UNLATCH_DISTANCE_MM 60.0     // UNLATCH is done beyond
+
+// Telecommand datagrams the TCMD thread buffers, one is executed per cycle
+#define SIM_TCMD_QUEUE 16
+
+// Sequence numbers remembered to ignore retransmissions
+#define SIM_TCMD_SEQ_HISTORY 16
+
+// Simulated Tamariw satellite on one address. Receives telecommands on its
+// port, executes one datagram per TCMD cycle and acknowledges it in the next
+// telemetry frame. Telemetry goes to whoever sent the last datagram, from
+// "Hello from Qt" until "Bye from Qt". A hello also forgets the sequence
+// numbers executed so far. The firmware threads are timers on
+// their sat_config.h periods and report their measured periods in dt[].
+class SatelliteSim : public QObject
+{
+    Q_OBJECT
+
+public:
+    SatelliteSim(const QHostAddress &address, quint16 port, QObject *parent = nullptr);
+
+    bool start();
+
+    // Sends binary telemetry_frame_t instead of text frames
+    void set_binary(bool binary) { binary_frames = binary; }
+
+    // Fraction of telemetry frames dropped on purpose
+    void set_loss(double fraction) { loss = fraction; }
+
+    // Sends telemetry to the ground station without waiting for a hello
+    void set_ground_station(const QHostAddress &ip, quint16 port);
+
+    QString name() const { return address.toString() + ':' + QString::number(port); }
+
+    enum dock_state state() const { return dock; }
+    quint64 frames_sent() const { return frames; }
+    quint64 tcmds_executed() const { return executed; }
+    quint64 tcmds_duplicate() const { return duplicates; }
+    quint64 tcmds_invalid() const { return invalid; }
+
+private slots:
+    void read_datagrams();
+
+    void coil_step();
+
+    void range_step();
+
+    void dock_step();
+
+    void tcmd_step();
+
+    void telem_step();
+
+private:
+    // Firmware threads, in the order of telemetry_t::dt
+    enum thread_idx
+    {
+        THREAD_DOCK,
+        THREAD_COIL,
+        THREAD_TELEM,
+        THREAD_TCMD,
+        THREAD_RANGE,
+        THREADS
+    };
+
+    typedef struct
+    {
+        double sp_mA;    // Set-point, the sign is the direction
+        double i_mA;
+        double integral; // PI integrator [mA s]
+        bool stopped;
+    } coil_t;
+
+    // Constant velocity Kalman filter of one ToF sensor
+    typedef struct
+    {
+        double d;   // [mm]
+        double v;   // [mm/s]
+        double p[2][2];
+        int rejected; // Consecutive measurements outside the gate
+        bool valid;
+    } kf1d_t;
+
+    // Measured period of a thread [s], restarts its clock
+    double period(enum thread_idx thread);
+
+    void start_thread(QTimer &timer, enum thread_idx thread, int period_ms, void (SatelliteSim::*step)());
+
+    void apply(const tcmd_param_t &param);
+
+    void set_state(enum dock_state state);
+
+    void set_coils(double mA);
+
+    void kf_step(kf1d_t &kf, double z, double dt);
+
+    double mean_distance() const;
+
+    double mean_velocity() const;
+
+    QHostAddress address;
+    quint16 port;
+    QUdpSocket socket;
+    QHostAddress gs_ip;
+    quint16 gs_port = 0;
+    bool binary_frames = false;
+    double loss = 0;
+
+    QTimer timers[THREADS];
+    QElapsedTimer clocks[THREADS];
+    float dt[THREADS] = {};
+
+    // Coils
+    coil_t coils[4] = {};
+    double em_kp = PID_COIL_KP;
+    double em_ki = PID_COIL_KI;
+
+    // Mechanics
+    double gap_mm = SIM_INITIAL_GAP_MM;
+    double gap_rate = 0; // [mm/s], negative closing
+    bool latched = false;
+
+    // Range
+    std::mt19937 rng;
+    std::normal_distribution<double> tof_noise{0.0, SIM_TOF_NOISE_MM};
+    float tof[4] = {};
+    kf1d_t kf[4] = {};
+    double kf_q00 = KF1D_Q_POS;
+    double kf_q11 = KF1D_Q_VEL;
+    double kf_r = KF1D_R;
+
+    // Docking
+    enum dock_state dock = DOCK_STATE_IDLE;
+    double dock_kp = DOCK_CONTROLLER_GAIN_KP;
+    double dock_ki = DOCK_CONTROLLER_GAIN_KI;
+    double dock_kd = DOCK_CONTROLLER_GAIN_KD;
+    double dock_kf = DOCK_CONTROLLER_GAIN_KF;
+    double latch_mA = DOCK_LATCH_CURRENT_mA;
+    double unlatch_mA = DOCK_UNLATCH_CURRENT_mA;
+    double velocity_sp = DOCK_CONTROL_VELOCITY_SP;
+    double distance_sp = DOCK_CONTROL_DISTANCE_SP_MM;
+    double dock_integral = 0;
+
+    // Telecommands
+    tcmd_t tcmd_queue[SIM_TCMD_QUEUE];
+    int tcmd_head = 0;
+    int tcmd_count = 0;
+    quint16 seq_history[SIM_TCMD_SEQ_HISTORY] = {};
+    int seq_next = 0;
+    quint16 ack = 0;
+
+    quint64 frames = 0;
+    quint16 frame_seq = 0;
+    quint64 executed = 0;
+    quint64 duplicates = 0;
+    quint64 invalid = 0;
+};
+
+#endif // SATELLITE_SIM_H
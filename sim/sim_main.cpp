@@ -0,0 +1,161 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTextStream>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <cstdio>
+
+#include "satellite_sim.h"
+#include "telecommand.h"
+
+// Simulated Tamariw satellites for developing and load-testing the ground
+// station, one per address starting at --bind
+
+// Telecommands each ground station sends in the gs-restart scenario
+#define SCENARIO_TCMDS 8
+
+// Ground station restarting in the middle of a session, against the first
+// unit: two ground stations one after the other send the same sequence
+// numbers, each after its hello. Every command has to be executed, none may
+// be taken for a retransmission. Returns the exit code.
+static int run_gs_restart(QCoreApplication &app, SatelliteSim *sim, const QHostAddress &ip, quint16 port, QTextStream &out)
+{
+    QUdpSocket *gs = nullptr;
+    int step = 0;
+
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, [&]() {
+        const int command = step % (SCENARIO_TCMDS + 1);
+
+        if (step == 2 * (SCENARIO_TCMDS + 1))
+        {
+            // The last command executes within a TCMD cycle
+            timer.stop();
+            QTimer::singleShot(2 * THREAD_PERIOD_TCMD_MILLIS, &app, [&]() {
+                const bool passed = sim->tcmds_executed() == 2 * SCENARIO_TCMDS && sim->tcmds_duplicate() == 0;
+
+                out << QString::asprintf("gs-restart: executed %llu of %d, duplicate %llu: %s",
+                                         (unsigned long long)sim->tcmds_executed(), 2 * SCENARIO_TCMDS,
+                                         (unsigned long long)sim->tcmds_duplicate(), passed ? "passed" : "FAILED")
+                    << Qt::endl;
+                app.exit(passed ? 0 : 1);
+            });
+            return;
+        }
+
+        if (command == 0)
+        {
+            // (Re)start, a new socket as a new process would have
+            delete gs;
+            gs = new QUdpSocket;
+            gs->bind();
+            gs->writeDatagram("Hello from Qt", ip, port);
+        }
+        else
+        {
+            tcmd_t cmd = {};
+            cmd.params[0] = {TCMD_EM_KP, 0.001 * command};
+            cmd.count = 1;
+            cmd.seq = quint16(command);
+            gs->writeDatagram(format_tcmd(cmd), ip, port);
+        }
+
+        step++;
+    });
+
+    // One datagram per TCMD cycle, so none waits in the unit's queue
+    timer.start(2 * THREAD_PERIOD_TCMD_MILLIS);
+
+    int code = app.exec();
+    delete gs;
+    return code;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulates Tamariw satellites on the firmware's UDP protocol");
+    parser.addHelpOption();
+    parser.addOption({"bind", "Address of the first unit", "address", "127.0.0.1"});
+    parser.addOption({"port", "Telecommand port of every unit", "port", "8080"});
+    parser.addOption({"units", "Number of units, on consecutive addresses", "n", "1"});
+    parser.addOption({"gs", "Send telemetry to the ground station at host:port without waiting for its hello", "host:port"});
+    parser.addOption({"binary", "Send binary frames instead of text frames"});
+    parser.addOption({"loss", "Fraction of telemetry frames to drop", "fraction", "0"});
+    parser.addOption({"scenario", "Run a scripted ground station against the first unit and exit, gs-restart", "name"});
+    parser.process(app);
+
+    QHostAddress first(parser.value("bind"));
+    quint16 port = parser.value("port").toUShort();
+    int units = parser.value("units").toInt();
+
+    if (first.protocol() != QAbstractSocket::IPv4Protocol || port == 0 || units < 1 ||
+        (parser.isSet("scenario") && parser.value("scenario") != "gs-restart"))
+    {
+        parser.showHelp(1);
+    }
+
+    QHostAddress gs_ip;
+    quint16 gs_port = 0;
+
+    if (parser.isSet("gs"))
+    {
+        QStringList gs = parser.value("gs").split(':');
+        gs_ip = QHostAddress(gs.value(0));
+        gs_port = gs.value(1).toUShort();
+
+        if (gs_ip.isNull() || gs_port == 0)
+        {
+            parser.showHelp(1);
+        }
+    }
+
+    QVector<SatelliteSim *> sims;
+
+    for (int i = 0; i < units; i++)
+    {
+        SatelliteSim *sim = new SatelliteSim(QHostAddress(first.toIPv4Address() + quint32(i)), port, &app);
+        sim->set_binary(parser.isSet("binary"));
+        sim->set_loss(parser.value("loss").toDouble());
+
+        if (gs_port != 0)
+        {
+            sim->set_ground_station(gs_ip, gs_port);
+        }
+
+        if (!sim->start())
+        {
+            fprintf(stderr, "Failed to start %s\n", qPrintable(sim->name()));
+            return 1;
+        }
+
+        out << "Unit " << sim->name() << Qt::endl;
+        sims.append(sim);
+    }
+
+    if (parser.isSet("scenario"))
+    {
+        return run_gs_restart(app, sims.first(), first, port, out);
+    }
+
+    // Status of every unit
+    QTimer status;
+    QObject::connect(&status, &QTimer::timeout, [&]() {
+        for (SatelliteSim *sim : std::as_const(sims))
+        {
+            out << QString::asprintf("%-21s state %d, frames %llu, tcmd %llu, duplicate %llu, invalid %llu",
+                                     qPrintable(sim->name()), int(sim->state()),
+                                     (unsigned long long)sim->frames_sent(), (unsigned long long)sim->tcmds_executed(),
+                                     (unsigned long long)sim->tcmds_duplicate(), (unsigned long long)sim->tcmds_invalid())
+                << Qt::endl;
+        }
+    });
+    status.start(5000);
+
+    return app.exec();
+}
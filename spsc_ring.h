@@ -0,0 +1,126 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// push() may only be called from one thread and pop() from one other thread.
+// The capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+    {
+        size_t n = 2;
+        while (n < capacity)
+        {
+            n <<= 1;
+        }
+
+        mask = n - 1;
+        slots.reset(new T[n]);
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side, returns false if the ring is full
+    bool push(const T &item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+
+        if (h - tail_cache > mask)
+        {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h - tail_cache > mask)
+            {
+                return false;
+            }
+        }
+
+        slots[h & mask] = item;
+        head.store(h + 1, std::memory_order_release);
+
+        // High-water mark, only the producer writes it
+        const size_t used = h + 1 - tail_cache;
+        if (used > peak.load(std::memory_order_relaxed))
+        {
+            peak.store(used, std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    // Consumer side, returns false if the ring is empty
+    bool pop(T &item)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+
+        if (t == head_cache)
+        {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t == head_cache)
+            {
+                return false;
+            }
+        }
+
+        item = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer side, pops up to max items into out and returns how many
+    size_t pop_batch(T *out, size_t max)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        head_cache = head.load(std::memory_order_acquire);
+
+        size_t n = head_cache - t;
+        if (n > max)
+        {
+            n = max;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            out[i] = slots[(t + i) & mask];
+        }
+
+        tail.store(t + n, std::memory_order_release);
+
+        return n;
+    }
+
+    // Approximate when called while the other side is running
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Highest occupancy seen by the producer
+    size_t peak_size() const { return peak.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t cache_line = 64;
+
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+
+    // Written by the producer
+    alignas(cache_line) std::atomic<size_t> head{0};
+    size_t tail_cache = 0;
+    std::atomic<size_t> peak{0};
+
+    // Written by the consumer
+    alignas(cache_line) std::atomic<size_t> tail{0};
+    size_t head_cache = 0;
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,103 @@
+#include "telecommand.h"
+
+#include <charconv>
+#include <cstring>
+
+QByteArray format_tcmd(const tcmd_t &cmd)
+{
+    QByteArray frame = "$";
+
+    for (int i = 0; i < cmd.count; i++)
+    {
+        if (i > 0)
+        {
+            frame += ';';
+        }
+
+        frame += QByteArray::number(cmd.params[i].idx) + ':' + QByteArray::number(cmd.params[i].value, 'f', 3);
+    }
+
+    frame += ",s:" + QByteArray::number(cmd.seq) + '#';
+
+    return frame;
+}
+
+// The whole of [p, end) is one number
+template <typename T>
+static bool parse_number(const char *p, const char *end, T &value)
+{
+    std::from_chars_result r = std::from_chars(p, end, value);
+
+    return r.ec == std::errc() && r.ptr == end;
+}
+
+bool parse_tcmd(QByteArrayView rx, tcmd_t &cmd)
+{
+    if (rx.size() < 2 || !rx.startsWith('$') || !rx.endsWith('#'))
+    {
+        return false;
+    }
+
+    const char *p = rx.data() + 1;
+    const char *end = rx.data() + rx.size() - 1;
+    const char *params_end = end;
+
+    cmd.count = 0;
+    cmd.seq = 0;
+
+    qsizetype s = QByteArrayView(p, end - p).lastIndexOf(QByteArrayView(",s:"));
+    if (s >= 0)
+    {
+        unsigned seq = 0;
+        params_end = p + s;
+
+        if (!parse_number(params_end + 3, end, seq) || seq > 0xFFFF)
+        {
+            return false;
+        }
+
+        cmd.seq = quint16(seq);
+    }
+
+    // "idx:value" pairs separated by ';'
+    while (p < params_end)
+    {
+        const char *sep = static_cast<const char *>(std::memchr(p, ';', params_end - p));
+        if (!sep)
+        {
+            sep = params_end;
+        }
+
+        const char *colon = static_cast<const char *>(std::memchr(p, ':', sep - p));
+        unsigned idx = 0;
+        double value = 0;
+
+        if (!colon || cmd.count == TCMD_BATCH_MAX ||
+            !parse_number(p, colon, idx) || idx >= TCMD_LENGTH ||
+            !parse_number(colon + 1, sep, value))
+        {
+            return false;
+        }
+
+        cmd.params[cmd.count++] = {tcmd_idx(idx), value};
+        p = sep + 1;
+    }
+
+    return cmd.count > 0;
+}
+
+enum tcmd_lane tcmd_lane_of(enum tcmd_idx idx)
+{
+    switch (idx)
+    {
+    case TCMD_DOCK_STATE_ABORT:
+    case TCMD_EM0_STOP:
+    case TCMD_EM1_STOP:
+    case TCMD_EM2_STOP:
+    case TCMD_EM3_STOP:
+    case TCMD_EM_STOP_ALL:
+        return TCMD_LANE_URGENT;
+    default:
+        return TCMD_LANE_NORMAL;
+    }
+}
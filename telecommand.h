@@ -0,0 +1,123 @@
+#ifndef TELECOMMAND_H
+#define TELECOMMAND_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "sat_config.h"
+
+// Add/remove new/obsolete telecommands as enum elements.
+// Please make sure it is identical to the one on embedded firmware.
+enum tcmd_idx
+{
+    // Coil PI controller gains
+    TCMD_EM_KP,
+    TCMD_EM_KI,
+
+    // Coil control set-points
+    TCMD_EM0,
+    TCMD_EM1,
+    TCMD_EM2,
+    TCMD_EM3,
+
+    // Coil enable/disable flags
+    TCMD_EM0_STOP,
+    TCMD_EM1_STOP,
+    TCMD_EM2_STOP,
+    TCMD_EM3_STOP,
+    TCMD_EM_STOP_ALL,
+
+    // KF noise covariances
+    TCMD_KF_R,
+    TCMD_KF_Q00,
+    TCMD_KF_Q11,
+
+    // Docking configurable parameters
+    TCMD_DOCK_KP,
+    TCMD_DOCK_KI,
+    TCMD_DOCK_KD,
+    TCMD_DOCK_KF,
+    TCMD_DOCK_LATCH_CURRENT,
+    TCMD_DOCK_UNLATCH_CURRENT,
+    TCMD_DOCK_VELOCITY_SP,
+    TCMD_DOCK_DISTANCE_SP,
+
+    // Docking states
+    TCMD_DOCK_STATE_START,
+    TCMD_DOCK_STATE_IDLE,
+    TCMD_DOCK_STATE_LATCH,
+    TCMD_DOCK_STATE_ABORT,
+    TCMD_DOCK_STATE_CAPTURE,
+    TCMD_DOCK_STATE_CONTROL,
+    TCMD_DOCK_STATE_UNLATCH,
+
+    // Number of enumerators
+    TCMD_LENGTH
+};
+
+// Default gap between telecommands, one per firmware TCMD thread cycle
+#define TCMD_PACING_MILLIS THREAD_PERIOD_TCMD_MILLIS
+
+// First retransmit timeout, one TCMD cycle plus two telemetry frames for the
+// echo. Doubles with every retransmission.
+#define TCMD_ACK_TIMEOUT_MILLIS (THREAD_PERIOD_TCMD_MILLIS + 2 * THREAD_PERIOD_TELEM_MILLIS)
+#define TCMD_MAX_ATTEMPTS 4
+
+// Transmissions of a command after which a unit that keeps sending telemetry
+// but never echoed any sequence number counts as firmware without acks
+#define TCMD_ACK_PROBE_ATTEMPTS 2
+
+// Most "idx:value" pairs carried by one telecommand datagram. The datagram
+// also has to fit into MAX_BUFFER_SIZE_TCMD.
+#define TCMD_BATCH_MAX 8
+
+// Telecommand queues, drained in this order with the same pacing
+enum tcmd_lane
+{
+    TCMD_LANE_URGENT, // Abort and stop commands, ahead of the normal lane
+    TCMD_LANE_NORMAL,
+    TCMD_LANES
+};
+
+typedef struct
+{
+    enum tcmd_idx idx;
+    double value;
+} tcmd_param_t;
+
+// One telecommand datagram, e.g. "$0:0.065;1:0.300,s:7#". All parameters are
+// applied in the same firmware TCMD cycle.
+typedef struct
+{
+    tcmd_param_t params[TCMD_BATCH_MAX];
+    int count;
+    enum tcmd_lane lane;
+    qint64 queued_ms;
+    quint16 seq;        // Echoed back in telemetry, 0 until first sent
+    int attempts;       // Transmissions so far
+    qint64 sent_us;     // First transmission
+    qint64 deadline_ms; // Retransmit if not acknowledged by then
+    quint64 frames;     // Telemetry frames received by the last transmission
+} tcmd_t;
+
+// Latency from queueing a telecommand until its datagram is written
+typedef struct
+{
+    quint64 count;
+    qint64 last_ms;
+    qint64 max_ms;
+    qint64 total_ms;
+} tcmd_stats_t;
+
+// "$idx:value;idx:value,s:seq#"
+QByteArray format_tcmd(const tcmd_t &cmd);
+
+// Reads the parameters and sequence number of a telecommand datagram, as the
+// firmware does. The sequence number is 0 if the datagram has none.
+bool parse_tcmd(QByteArrayView rx, tcmd_t &cmd);
+
+// Lane a command is queued in, commands that must not wait behind queued
+// parameter updates are urgent
+enum tcmd_lane tcmd_lane_of(enum tcmd_idx idx);
+
+#endif // TELECOMMAND_H
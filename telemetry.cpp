@@ -0,0 +1,372 @@
+#include "telemetry.h"
+#include "sat_config.h"
+
+#include <QDebug>
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+// Slicing-by-8 tables, crc16_table[k][x] is the CRC of byte x followed by k zero bytes
+static constexpr std::array<std::array<uint16_t, 256>, 8> crc16_make_table()
+{
+    std::array<std::array<uint16_t, 256>, 8> table{};
+
+    for (int x = 0; x < 256; x++)
+    {
+        uint16_t crc = x << 8;
+        for (int i = 0; i < 8; ++i) {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ 0x1021;
+            else
+                crc <<= 1;
+        }
+        table[0][x] = crc;
+    }
+
+    for (int k = 1; k < 8; k++)
+    {
+        for (int x = 0; x < 256; x++)
+        {
+            uint16_t prev = table[k - 1][x];
+            table[k][x] = (prev << 8) ^ table[0][prev >> 8];
+        }
+    }
+
+    return table;
+}
+
+static constexpr std::array<std::array<uint16_t, 256>, 8> crc16_table = crc16_make_table();
+
+uint16_t crc16_ccitt(QByteArrayView data)
+{
+    uint16_t crc = 0xFFFF;
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data.data());
+    qsizetype n = data.size();
+
+    for (; n >= 8; n -= 8, p += 8)
+    {
+        crc = crc16_table[7][p[0] ^ (crc >> 8)] ^
+              crc16_table[6][p[1] ^ (crc & 0xFF)] ^
+              crc16_table[5][p[2]] ^
+              crc16_table[4][p[3]] ^
+              crc16_table[3][p[4]] ^
+              crc16_table[2][p[5]] ^
+              crc16_table[1][p[6]] ^
+              crc16_table[0][p[7]];
+    }
+
+    for (; n > 0; n--, p++)
+    {
+        crc = (crc << 8) ^ crc16_table[0][*p ^ (crc >> 8)];
+    }
+
+    return crc;
+}
+
+bool check_telemetry_crc(QByteArrayView rx, const telemetry_t &t)
+{
+    if (rx.isEmpty())
+    {
+        return false;
+    }
+
+    if ((uint8_t)rx.front() == TELEMETRY_FRAME_MAGIC)
+    {
+        return rx.size() == qsizetype(sizeof(telemetry_frame_t)) &&
+               crc16_ccitt(rx.first(offsetof(telemetry_frame_t, crc))) == t.crc;
+    }
+
+    // Assumed: text frames carry the CRC of everything between '$' and ",r:",
+    // see telemetry_crc_enforced()
+    qsizetype r = rx.lastIndexOf(QByteArrayView(",r:"));
+    if (r < 1)
+    {
+        return false;
+    }
+
+    return crc16_ccitt(rx.sliced(1, r - 1)) == t.crc;
+}
+
+bool telemetry_crc_enforced(QByteArrayView rx)
+{
+    return TELEMETRY_ENFORCE_TEXT_CRC || (!rx.isEmpty() && (uint8_t)rx.front() == TELEMETRY_FRAME_MAGIC);
+}
+
+void link_stats_frame(link_stats_t &s, int64_t now_ms, int32_t seq)
+{
+    if (seq >= 0)
+    {
+        // Frames ahead of the last one, modulo the 16 bit counter
+        const uint16_t ahead = uint16_t(seq - s.last_seq);
+
+        if (s.last_seq < 0 || (ahead >= 0x8000 && 0x10000 - ahead > LINK_STATS_REORDER_FRAMES))
+        {
+            // First frame, or the sender restarted
+            s.last_seq = seq;
+        }
+        else if (ahead >= 0x8000)
+        {
+            // Late, counted as dropped when its successor arrived
+            if (s.dropped > 0)
+            {
+                s.dropped--;
+            }
+        }
+        else if (ahead > 0)
+        {
+            s.dropped += ahead - 1;
+            s.last_seq = seq;
+        }
+    }
+    else if (s.last_rx_ms >= 0)
+    {
+        // Frames that should have arrived in between, with half a period of slack
+        int64_t missed = (now_ms - s.last_rx_ms + THREAD_PERIOD_TELEM_MILLIS / 2) / THREAD_PERIOD_TELEM_MILLIS - 1;
+        if (missed > 0)
+        {
+            s.dropped += missed;
+        }
+    }
+
+    s.last_rx_ms = now_ms;
+    s.frames++;
+}
+
+// Parses up to n 'x' separated values from [p, end). Missing or malformed
+// values are left at 0, surplus values are ignored.
+template <typename T>
+static void parse_values(const char *p, const char *end, T *out, int n)
+{
+    for (int i = 0; i < n && p <= end; i++)
+    {
+        const char *sep = static_cast<const char *>(std::memchr(p, 'x', end - p));
+        if (!sep)
+        {
+            sep = end;
+        }
+
+        T value = 0;
+        if (std::from_chars(p, sep, value).ptr != sep)
+        {
+            value = 0;
+        }
+
+        out[i] = value;
+        p = sep + 1;
+    }
+}
+
+bool parse_telemetry(QByteArrayView rx, telemetry_t &t)
+{
+    if (!rx.startsWith('$') || !rx.endsWith('#')){
+        qDebug() << "Invalid frame format";
+        return false;
+    }
+
+    // Initialize all values to 0 first
+    for (int i = 0; i < 4; ++i) {
+        t.d[i] = 0.0f;
+        t.c[i] = 0.0f;
+        t.kf_d[i] = 0.0f;
+        t.kf_v[i] = 0.0f;
+    }
+    for (int i = 0; i < 5; ++i) {
+        t.dt[i] = 0.0f;
+    }
+    t.state = DOCK_STATE_START;
+    t.ack = 0;
+    t.crc = 0;
+    t.seq = -1;
+
+    // Payload between '$' and '#'
+    const char *p = rx.data() + 1;
+    const char *end = rx.data() + rx.size() - 1;
+
+    // Iterate over each comma separated "type:values" component
+    while (p <= end)
+    {
+        const char *next = static_cast<const char *>(std::memchr(p, ',', end - p));
+        if (!next)
+        {
+            next = end;
+        }
+
+        // Exactly one single character type followed by a colon
+        if (next - p < 2 || p[1] != ':' || std::memchr(p + 2, ':', next - p - 2))
+        {
+            // qDebug() << "Invalid component:" << QByteArrayView(p, next - p);
+            return false;
+        }
+
+        const char type = p[0];
+        const char *values = p + 2;
+
+        switch (type)
+        {
+        case 'd': // Distance
+            parse_values(values, next, t.d, 4);
+            break;
+        case 'c': // Current
+            parse_values(values, next, t.c, 4);
+            break;
+        case 'e': // KF distance
+            parse_values(values, next, t.kf_d, 4);
+            break;
+        case 'f': // KF velocity
+            parse_values(values, next, t.kf_v, 4);
+            break;
+        case 'g': // Docking state
+        {
+            unsigned state = 0;
+            parse_values(values, next, &state, 1);
+            t.state = (dock_state)state;
+            break;
+        }
+        case 'h': // Thread periods
+            parse_values(values, next, t.dt, 5);
+            break;
+        case 'a': // Telecommand acknowledgement
+        {
+            unsigned ack = 0;
+            parse_values(values, next, &ack, 1);
+            t.ack = ack;
+            break;
+        }
+        case 'r': // CRC
+        {
+            unsigned crc = 0;
+            parse_values(values, next, &crc, 1);
+            t.crc = crc;
+            break;
+        }
+        default:
+            // qDebug() << "Unknown data type:" << type;
+            return false;
+        }
+
+        p = next + 1;
+    }
+
+    return true;
+}
+
+// Appends "type:v0xv1x..." and a separating comma
+static void format_values(QByteArray &out, char type, const float *values, int n)
+{
+    out += type;
+    out += ':';
+
+    for (int i = 0; i < n; i++)
+    {
+        if (i > 0)
+        {
+            out += 'x';
+        }
+
+        out += QByteArray::number(values[i], 'g', 5);
+    }
+
+    out += ',';
+}
+
+QByteArray format_telemetry(const telemetry_t &t)
+{
+    QByteArray frame;
+    frame.reserve(MAX_BUFFER_SIZE_TELEM);
+    frame += '$';
+
+    format_values(frame, 'd', t.d, 4);
+    format_values(frame, 'c', t.c, 4);
+    format_values(frame, 'e', t.kf_d, 4);
+    format_values(frame, 'f', t.kf_v, 4);
+    frame += "g:" + QByteArray::number(int(t.state)) + ',';
+    format_values(frame, 'h', t.dt, 5);
+    frame += "a:" + QByteArray::number(t.ack);
+
+    // Covers everything between '$' and ",r:"
+    uint16_t crc = crc16_ccitt(QByteArrayView(frame).sliced(1));
+    frame += ",r:" + QByteArray::number(crc) + '#';
+
+    return frame;
+}
+
+bool decode_telemetry_frame(QByteArrayView rx, telemetry_t &t)
+{
+    telemetry_frame_t f;
+
+    if (rx.size() != qsizetype(sizeof(f)))
+    {
+        return false;
+    }
+
+    // The datagram buffer has no alignment guarantees, copy onto the stack
+    std::memcpy(&f, rx.data(), sizeof(f));
+
+    if (f.magic != TELEMETRY_FRAME_MAGIC || f.version != TELEMETRY_FRAME_VERSION)
+    {
+        return false;
+    }
+
+    if (f.state > DOCK_STATE_ABORT)
+    {
+        return false;
+    }
+
+    std::memcpy(t.d, f.d, sizeof(t.d));
+    std::memcpy(t.c, f.c, sizeof(t.c));
+    std::memcpy(t.dt, f.dt, sizeof(t.dt));
+    std::memcpy(t.kf_d, f.kf_d, sizeof(t.kf_d));
+    std::memcpy(t.kf_v, f.kf_v, sizeof(t.kf_v));
+    t.state = (dock_state)f.state;
+    t.ack = f.ack;
+    t.crc = f.crc;
+    t.seq = f.seq;
+
+    return true;
+}
+
+bool decode_telemetry(QByteArrayView rx, telemetry_t &t)
+{
+    if (rx.isEmpty())
+    {
+        return false;
+    }
+
+    switch ((uint8_t)rx.front())
+    {
+    case '$':
+        return parse_telemetry(rx, t);
+    case TELEMETRY_FRAME_MAGIC:
+        return decode_telemetry_frame(rx, t);
+    default:
+        return false;
+    }
+}
+
+qsizetype encode_telemetry_frame(const telemetry_t &t, uint16_t seq, char *out, qsizetype size)
+{
+    telemetry_frame_t f;
+
+    if (size < qsizetype(sizeof(f)))
+    {
+        return 0;
+    }
+
+    f.magic = TELEMETRY_FRAME_MAGIC;
+    f.version = TELEMETRY_FRAME_VERSION;
+    f.seq = seq;
+    std::memcpy(f.d, t.d, sizeof(f.d));
+    std::memcpy(f.c, t.c, sizeof(f.c));
+    std::memcpy(f.dt, t.dt, sizeof(f.dt));
+    std::memcpy(f.kf_d, t.kf_d, sizeof(f.kf_d));
+    std::memcpy(f.kf_v, t.kf_v, sizeof(f.kf_v));
+    f.state = (uint8_t)t.state;
+    f.ack = t.ack;
+    f.crc = crc16_ccitt(QByteArrayView(reinterpret_cast<const char *>(&f), offsetof(telemetry_frame_t, crc)));
+
+    std::memcpy(out, &f, sizeof(f));
+
+    return sizeof(f);
+}
@@ -0,0 +1,113 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <cstdint>
+
+// Satellite docking states.
+// Please make sure it is identical to the one on embedded firmware.
+enum dock_state
+{
+    DOCK_STATE_START,   // Indicates the start of docking sequence (received from third party)
+    DOCK_STATE_IDLE,    // Do nothing at all
+    DOCK_STATE_CAPTURE, // Passive coil actuation to bring satellites together
+    DOCK_STATE_CONTROL, // Soft docking control with position and velocity feedback
+    DOCK_STATE_LATCH,   // Extra push to overcome latch friction
+    DOCK_STATE_UNLATCH, // Repel latched satellites
+    DOCK_STATE_ABORT    // Abort the docking sequence under unsafe conditions
+};
+
+typedef struct
+{
+    float d[4];    // ToF measurements [mm]
+    float c[4];    // Electromagnet current feedback [mA]
+    float dt[5];    // Thread periods [ms]
+    float kf_d[4]; // Kalman Filter distance estimates
+    float kf_v[4]; // Kalman Filter velocity estimates
+    enum dock_state state; // Current docking state
+    uint16_t ack;  // Sequence number of the last telecommand executed, 0 if none
+    uint16_t crc;
+    int32_t seq;   // Frame counter of binary frames, -1 for text frames which have none
+} telemetry_t;
+
+// Binary telemetry frame, an alternative to the "$d:..#" text frame.
+// The first byte tells the two formats apart ('$' vs. TELEMETRY_FRAME_MAGIC).
+// Multi-byte fields are little-endian, as on the STM32 and the ground station.
+// Please make sure it is identical to the one on embedded firmware.
+#define TELEMETRY_FRAME_MAGIC 0xA5
+#define TELEMETRY_FRAME_VERSION 2
+
+#pragma pack(push, 1)
+typedef struct
+{
+    uint8_t magic;   // TELEMETRY_FRAME_MAGIC
+    uint8_t version; // TELEMETRY_FRAME_VERSION
+    uint16_t seq;    // Frame counter, wraps around
+    float d[4];
+    float c[4];
+    float dt[5];
+    float kf_d[4];
+    float kf_v[4];
+    uint8_t state;
+    uint16_t ack;    // Telecommand sequence number echo, 0 if none
+    uint16_t crc;    // CRC16-CCITT over all preceding bytes
+} telemetry_frame_t;
+#pragma pack(pop)
+
+static_assert(sizeof(telemetry_frame_t) == 93, "telemetry_frame_t must be packed");
+
+// Receive path counters, shown in the CONNECT tab
+typedef struct
+{
+    uint64_t frames;    // Frames that decoded and passed the CRC check
+    uint64_t dropped;   // Frames missing between two valid ones, see link_stats_frame()
+    int64_t last_rx_ms; // Arrival time of the last valid frame, -1 before the first one
+    int32_t last_seq;   // Frame counter of the last binary frame, -1 if none yet
+} link_stats_t;
+
+// Binary frames this far behind the last one are late, further back the
+// sender restarted its counter
+#define LINK_STATS_REORDER_FRAMES 64
+
+uint16_t crc16_ccitt(QByteArrayView data);
+
+// Verifies t.crc against the frame it was decoded from
+bool check_telemetry_crc(QByteArrayView rx, const telemetry_t &t);
+
+// Whether a frame failing check_telemetry_crc() is dropped. Binary frames are
+// defined in this file and always are. What the firmware's text CRC covers has
+// not been checked against the firmware source yet (the old parser always
+// read r as 0), so mismatching text frames are only counted and delivered
+// unless TELEMETRY_ENFORCE_TEXT_CRC is set.
+bool telemetry_crc_enforced(QByteArrayView rx);
+
+#ifndef TELEMETRY_ENFORCE_TEXT_CRC
+#define TELEMETRY_ENFORCE_TEXT_CRC 0
+#endif
+
+// Counts a valid frame arriving at now_ms. Binary frames count the drops from
+// gaps in their frame counter seq, with wraparound; a late frame takes back
+// the drop it was counted as. Text frames carry no counter (seq -1), their
+// drops are guessed from the arrival gap, expecting one frame per
+// THREAD_PERIOD_TELEM_MILLIS, and show up falsely when the ground station
+// stalls or frames arrive bunched.
+void link_stats_frame(link_stats_t &s, int64_t now_ms, int32_t seq);
+
+// Text frame parser, e.g. "$d:1x2x3x4,c:...,r:1234#", single pass without allocations
+bool parse_telemetry(QByteArrayView rx, telemetry_t &t);
+
+// Text frame for t with its CRC, the counterpart of parse_telemetry()
+QByteArray format_telemetry(const telemetry_t &t);
+
+// Binary frame decoder, reads straight from the datagram buffer
+bool decode_telemetry_frame(QByteArrayView rx, telemetry_t &t);
+
+// Picks the decoder from the first byte of the datagram
+bool decode_telemetry(QByteArrayView rx, telemetry_t &t);
+
+// Writes a binary frame for t into out, returns the number of bytes written
+qsizetype encode_telemetry_frame(const telemetry_t &t, uint16_t seq, char *out, qsizetype size);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,367 @@
+#include "telemetry_history.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cstring>
+
+// Appends the low n bits of value, n in [1, 64]
+static void put_bits(std::vector<uint64_t> &words, uint64_t &pos, uint64_t value, int n)
+{
+    if (n < 64)
+    {
+        value &= (uint64_t(1) << n) - 1;
+    }
+
+    int used = int(pos & 63);
+    if (used == 0)
+    {
+        words.push_back(0);
+    }
+
+    int free = 64 - used;
+    if (n <= free)
+    {
+        words.back() |= value << (free - n);
+    }
+    else
+    {
+        words.back() |= value >> (n - free);
+        words.push_back(value << (64 - (n - free)));
+    }
+
+    pos += n;
+}
+
+typedef struct
+{
+    const uint64_t *words;
+    uint64_t pos;
+
+    // Next n bits, n in [1, 64]
+    uint64_t get(int n)
+    {
+        const uint64_t *w = words + (pos >> 6);
+        int used = int(pos & 63);
+        int avail = 64 - used;
+        uint64_t value;
+
+        if (n <= avail)
+        {
+            value = (w[0] << used) >> (64 - n);
+        }
+        else
+        {
+            value = ((w[0] << used) >> used << (n - avail)) | (w[1] >> (64 - (n - avail)));
+        }
+
+        pos += n;
+        return value;
+    }
+
+    int64_t get_signed(int n)
+    {
+        return int64_t(get(n) << (64 - n)) >> (64 - n);
+    }
+} bit_reader_t;
+
+static bool fits(int64_t value, int n)
+{
+    return value >= -(int64_t(1) << (n - 1)) && value < (int64_t(1) << (n - 1));
+}
+
+void TelemetryHistory::clear()
+{
+    chunk_list.clear();
+    count = 0;
+}
+
+void TelemetryHistory::append(int64_t t_ns, const telemetry_t &t)
+{
+    double values[TELEM_CHANNELS];
+
+    for (int i = 0; i < 4; i++)
+    {
+        values[TELEM_CH_D0 + i] = t.d[i];
+        values[TELEM_CH_C0 + i] = t.c[i];
+        values[TELEM_CH_KF_D0 + i] = t.kf_d[i];
+        values[TELEM_CH_KF_V0 + i] = t.kf_v[i];
+    }
+
+    append(t_ns, values);
+}
+
+void TelemetryHistory::open_chunk(int64_t t_ns)
+{
+    if (!chunk_list.empty())
+    {
+        // Sealed, give back what the vectors grew ahead
+        for (bit_stream_t &s : chunk_list.back().columns)
+        {
+            s.words.shrink_to_fit();
+        }
+    }
+
+    int64_t last_ns = chunk_list.empty() ? t_ns : std::max(chunk_list.back().last_ns, t_ns);
+
+    chunk_list.emplace_back();
+    chunk_t &chunk = chunk_list.back();
+    chunk.first_ns = t_ns;
+    chunk.last_ns = last_ns;
+    chunk.count = 0;
+
+    for (bit_stream_t &s : chunk.columns)
+    {
+        s.bits = 0;
+    }
+
+    // Every chunk decodes on its own
+    prev_delta = 0;
+    for (xor_state_t &p : prev)
+    {
+        p = {0, 64, 64};
+    }
+}
+
+void TelemetryHistory::append(int64_t t_ns, const double *values)
+{
+    if (chunk_list.empty() || chunk_list.back().count == HISTORY_CHUNK_SAMPLES)
+    {
+        // The first timestamp is in the chunk itself
+        open_chunk(t_ns);
+    }
+    else
+    {
+        chunk_t &chunk = chunk_list.back();
+        bit_stream_t &s = chunk.columns[0];
+
+        // Wrapping arithmetic, any order of timestamps round-trips
+        int64_t delta = int64_t(uint64_t(t_ns) - uint64_t(prev_ns));
+        int64_t dod = int64_t(uint64_t(delta) - uint64_t(prev_delta));
+
+        // Buckets sized for ns: +-8 us, +-524 us, +-134 ms of jitter
+        if (dod == 0)
+        {
+            put_bits(s.words, s.bits, 0b0, 1);
+        }
+        else if (fits(dod, 14))
+        {
+            put_bits(s.words, s.bits, 0b10, 2);
+            put_bits(s.words, s.bits, uint64_t(dod), 14);
+        }
+        else if (fits(dod, 20))
+        {
+            put_bits(s.words, s.bits, 0b110, 3);
+            put_bits(s.words, s.bits, uint64_t(dod), 20);
+        }
+        else if (fits(dod, 28))
+        {
+            put_bits(s.words, s.bits, 0b1110, 4);
+            put_bits(s.words, s.bits, uint64_t(dod), 28);
+        }
+        else
+        {
+            put_bits(s.words, s.bits, 0b1111, 4);
+            put_bits(s.words, s.bits, uint64_t(dod), 64);
+        }
+
+        prev_delta = delta;
+        chunk.last_ns = std::max(chunk.last_ns, t_ns);
+    }
+
+    prev_ns = t_ns;
+    chunk_t &chunk = chunk_list.back();
+
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        bit_stream_t &s = chunk.columns[ch + 1];
+        xor_state_t &p = prev[ch];
+        uint64_t bits;
+        std::memcpy(&bits, &values[ch], sizeof(bits));
+
+        uint64_t x = bits ^ p.bits;
+
+        if (x == 0)
+        {
+            put_bits(s.words, s.bits, 0b0, 1);
+        }
+        else
+        {
+            int leading = std::min(qCountLeadingZeroBits(x), 31u);
+            int trailing = qCountTrailingZeroBits(x);
+
+            if (leading >= p.leading && trailing >= p.trailing)
+            {
+                // Fits the meaningful bits of the previous XOR
+                put_bits(s.words, s.bits, 0b10, 2);
+                put_bits(s.words, s.bits, x >> p.trailing, 64 - p.leading - p.trailing);
+            }
+            else
+            {
+                int length = 64 - leading - trailing;
+
+                put_bits(s.words, s.bits, 0b11, 2);
+                put_bits(s.words, s.bits, uint64_t(leading), 5);
+                put_bits(s.words, s.bits, uint64_t(length & 63), 6); // 64 as 0
+                put_bits(s.words, s.bits, x >> trailing, length);
+
+                p.leading = uint8_t(leading);
+                p.trailing = uint8_t(trailing);
+            }
+        }
+
+        p.bits = bits;
+    }
+
+    chunk.count++;
+    count++;
+}
+
+size_t TelemetryHistory::find_chunk(int64_t t_ns) const
+{
+    auto it = std::lower_bound(chunk_list.begin(), chunk_list.end(), t_ns,
+                               [](const chunk_t &chunk, int64_t t) { return chunk.last_ns < t; });
+
+    return size_t(it - chunk_list.begin());
+}
+
+void TelemetryHistory::decode_keys(const chunk_t &chunk, double *keys) const
+{
+    bit_reader_t r = {chunk.columns[0].words.data(), 0};
+    int64_t t = chunk.first_ns;
+    int64_t delta = 0;
+
+    keys[0] = t * 1e-9;
+
+    for (uint32_t i = 1; i < chunk.count; i++)
+    {
+        int64_t dod;
+
+        if (!r.get(1))
+        {
+            dod = 0;
+        }
+        else if (!r.get(1))
+        {
+            dod = r.get_signed(14);
+        }
+        else if (!r.get(1))
+        {
+            dod = r.get_signed(20);
+        }
+        else if (!r.get(1))
+        {
+            dod = r.get_signed(28);
+        }
+        else
+        {
+            dod = int64_t(r.get(64));
+        }
+
+        delta = int64_t(uint64_t(delta) + uint64_t(dod));
+        t = int64_t(uint64_t(t) + uint64_t(delta));
+        keys[i] = t * 1e-9;
+    }
+}
+
+void TelemetryHistory::decode_values(const chunk_t &chunk, int ch, double *values) const
+{
+    bit_reader_t r = {chunk.columns[ch + 1].words.data(), 0};
+    uint64_t bits = 0;
+    int leading = 0;
+    int trailing = 0;
+
+    for (uint32_t i = 0; i < chunk.count; i++)
+    {
+        if (r.get(1))
+        {
+            if (r.get(1))
+            {
+                leading = int(r.get(5));
+                int length = int(r.get(6));
+                length = length == 0 ? 64 : length;
+                trailing = 64 - leading - length;
+            }
+
+            bits ^= r.get(64 - leading - trailing) << trailing;
+        }
+
+        std::memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+void TelemetryHistory::decode(size_t c, int ch, std::vector<double> &keys, std::vector<double> &values) const
+{
+    const chunk_t &chunk = chunk_list[c];
+
+    keys.resize(chunk.count);
+    values.resize(chunk.count);
+
+    decode_keys(chunk, keys.data());
+    decode_values(chunk, ch, values.data());
+}
+
+size_t TelemetryHistory::read(int64_t from_ns, int64_t to_ns, int ch, std::vector<double> &keys, std::vector<double> &values) const
+{
+    const double from = from_ns * 1e-9;
+    const double to = to_ns * 1e-9;
+    size_t n = 0;
+
+    keys.clear();
+    values.clear();
+
+    for (size_t c = find_chunk(from_ns); c < chunk_list.size() && chunk_list[c].first_ns <= to_ns; c++)
+    {
+        const chunk_t &chunk = chunk_list[c];
+
+        // Decode behind the kept samples, then keep the ones in range
+        keys.resize(n + chunk.count);
+        values.resize(n + chunk.count);
+        decode_keys(chunk, keys.data() + n);
+        decode_values(chunk, ch, values.data() + n);
+
+        const size_t end = n + chunk.count;
+
+        for (size_t i = n; i < end; i++)
+        {
+            if (keys[i] >= from && keys[i] <= to)
+            {
+                keys[n] = keys[i];
+                values[n] = values[i];
+                n++;
+            }
+        }
+    }
+
+    keys.resize(n);
+    values.resize(n);
+
+    return n;
+}
+
+uint64_t TelemetryHistory::column_bits(int col) const
+{
+    uint64_t bits = 0;
+
+    for (const chunk_t &chunk : chunk_list)
+    {
+        bits += chunk.columns[col].bits;
+    }
+
+    return bits;
+}
+
+size_t TelemetryHistory::bytes() const
+{
+    size_t bytes = chunk_list.capacity() * sizeof(chunk_t);
+
+    for (const chunk_t &chunk : chunk_list)
+    {
+        for (const bit_stream_t &s : chunk.columns)
+        {
+            bytes += s.words.capacity() * sizeof(uint64_t);
+        }
+    }
+
+    return bytes;
+}
@@ -0,0 +1,98 @@
+#ifndef TELEMETRY_HISTORY_H
+#define TELEMETRY_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "telemetry_store.h"
+
+// Samples per compressed chunk, about 50 s of telemetry at the 50 ms period
+#define HISTORY_CHUNK_SAMPLES 1024
+
+// Columns of a chunk: the timestamps, then one per telemetry_channel
+#define HISTORY_COLUMNS (TELEM_CHANNELS + 1)
+
+// Every telemetry sample of a session, compressed in memory as in Gorilla
+// (Pelkonen et al., VLDB 2015): timestamps [ns] as the delta of their
+// deltas, values as the XOR with the previous value of the channel. Samples
+// are kept in chunks of HISTORY_CHUNK_SAMPLES with a bit stream per column,
+// so a plot decodes only the columns and chunks of the range it shows.
+class TelemetryHistory
+{
+public:
+    TelemetryHistory() = default;
+
+    void clear();
+
+    // O(1), t_ns on the same axis as the plots, e.g. since the first frame
+    void append(int64_t t_ns, const telemetry_t &t);
+
+    void append(int64_t t_ns, const double *values);
+
+    uint64_t size() const { return count; }
+
+    size_t chunks() const { return chunk_list.size(); }
+
+    // Samples of chunk c
+    size_t chunk_size(size_t c) const { return chunk_list[c].count; }
+
+    // First and latest timestamp of chunk c
+    int64_t chunk_begin_ns(size_t c) const { return chunk_list[c].first_ns; }
+    int64_t chunk_end_ns(size_t c) const { return chunk_list[c].last_ns; }
+
+    // First chunk with samples at or after t_ns, chunks() if there is none
+    size_t find_chunk(int64_t t_ns) const;
+
+    // Decodes the timestamps [s] and channel ch of chunk c. The vectors are
+    // resized to the chunk, so reusing them across calls does not allocate.
+    void decode(size_t c, int ch, std::vector<double> &keys, std::vector<double> &values) const;
+
+    // Samples of channel ch in [from_ns, to_ns], decoded chunk by chunk into
+    // the vectors, returns their number
+    size_t read(int64_t from_ns, int64_t to_ns, int ch, std::vector<double> &keys, std::vector<double> &values) const;
+
+    // Compressed bits of a column (0 timestamps, ch + 1 channels)
+    uint64_t column_bits(int col) const;
+
+    // Memory held by the history and by the same samples as doubles
+    size_t bytes() const;
+    size_t raw_bytes() const { return count * HISTORY_COLUMNS * sizeof(double); }
+
+private:
+    typedef struct
+    {
+        std::vector<uint64_t> words; // MSB first
+        uint64_t bits;
+    } bit_stream_t;
+
+    typedef struct
+    {
+        int64_t first_ns;
+        int64_t last_ns; // Latest timestamp up to and including this chunk
+        uint32_t count;
+        bit_stream_t columns[HISTORY_COLUMNS];
+    } chunk_t;
+
+    // Encoder state of the open (last) chunk
+    typedef struct
+    {
+        uint64_t bits;    // Previous value
+        uint8_t leading;  // Leading and trailing zeros of the previous XOR,
+        uint8_t trailing; // 64 before the first one
+    } xor_state_t;
+
+    void open_chunk(int64_t t_ns);
+
+    void decode_keys(const chunk_t &chunk, double *keys) const;
+
+    void decode_values(const chunk_t &chunk, int ch, double *values) const;
+
+    std::vector<chunk_t> chunk_list;
+    uint64_t count = 0;
+    int64_t prev_ns = 0;
+    int64_t prev_delta = 0;
+    xor_state_t prev[TELEM_CHANNELS];
+};
+
+#endif // TELEMETRY_HISTORY_H
@@ -0,0 +1,158 @@
+#include "telemetry_lod.h"
+
+#include <algorithm>
+
+void TelemetryLod::clear()
+{
+    for (std::vector<bucket_t> &level : levels)
+    {
+        level.clear();
+    }
+
+    count = 0;
+}
+
+uint64_t TelemetryLod::bucket_samples(int level)
+{
+    uint64_t n = LOD_BASE_SAMPLES;
+
+    for (int l = 0; l < level; l++)
+    {
+        n *= LOD_FANOUT;
+    }
+
+    return n;
+}
+
+void TelemetryLod::append(double key, const telemetry_t &t)
+{
+    double values[TELEM_CHANNELS];
+
+    for (int i = 0; i < 4; i++)
+    {
+        values[TELEM_CH_D0 + i] = t.d[i];
+        values[TELEM_CH_C0 + i] = t.c[i];
+        values[TELEM_CH_KF_D0 + i] = t.kf_d[i];
+        values[TELEM_CH_KF_V0 + i] = t.kf_v[i];
+    }
+
+    append(key, values);
+}
+
+void TelemetryLod::append(double key, const double *values)
+{
+    for (int l = 0; l < LOD_LEVELS; l++)
+    {
+        std::vector<bucket_t> &level = levels[l];
+
+        if (count % bucket_samples(l) == 0)
+        {
+            bucket_t b;
+            b.first_key = key;
+            b.last_key = key;
+
+            for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+            {
+                b.min[ch] = float(values[ch]);
+                b.max[ch] = float(values[ch]);
+            }
+
+            level.push_back(b);
+            continue;
+        }
+
+        bucket_t &b = level.back();
+        b.last_key = std::max(b.last_key, key);
+
+        for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+        {
+            float v = float(values[ch]);
+
+            if (v < b.min[ch])
+            {
+                b.min[ch] = v;
+            }
+            if (v > b.max[ch])
+            {
+                b.max[ch] = v;
+            }
+        }
+    }
+
+    count++;
+}
+
+int TelemetryLod::level_for(double from, double to, int pixels) const
+{
+    if (count < 2 || pixels <= 0 || to <= from)
+    {
+        return -1;
+    }
+
+    const double first = levels[0].front().first_key;
+    const double span = last_key() - first;
+
+    if (span <= 0)
+    {
+        return -1;
+    }
+
+    // Visible samples at the session's average rate
+    const double visible = count * (std::min(to, last_key()) - std::max(from, first)) / span;
+    const double per_pixel = visible / pixels;
+
+    int level = -1;
+    while (level + 1 < LOD_LEVELS && double(bucket_samples(level + 1)) <= per_pixel)
+    {
+        level++;
+    }
+
+    return level;
+}
+
+size_t TelemetryLod::envelope(int level, double from, double to, int ch, std::vector<double> &keys, std::vector<double> &values) const
+{
+    const std::vector<bucket_t> &buckets = levels[level];
+
+    keys.clear();
+    values.clear();
+
+    // Arrival times only grow within a session, and so do the buckets
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), from,
+                               [](const bucket_t &b, double key) { return b.last_key < key; });
+
+    // One bucket past either edge, so the line runs to the plot's border
+    if (it != buckets.begin())
+    {
+        --it;
+    }
+
+    for (; it != buckets.end(); ++it)
+    {
+        double middle = (it->first_key + it->last_key) / 2;
+
+        keys.push_back(middle);
+        values.push_back(it->min[ch]);
+        keys.push_back(middle);
+        values.push_back(it->max[ch]);
+
+        if (it->first_key > to)
+        {
+            break;
+        }
+    }
+
+    return keys.size();
+}
+
+size_t TelemetryLod::bytes() const
+{
+    size_t bytes = 0;
+
+    for (const std::vector<bucket_t> &level : levels)
+    {
+        bytes += level.capacity() * sizeof(bucket_t);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,70 @@
+#ifndef TELEMETRY_LOD_H
+#define TELEMETRY_LOD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "telemetry_store.h"
+
+// Samples per bucket of the finest level, plots zoomed in further than this
+// per pixel draw the raw samples of TelemetryHistory
+#define LOD_BASE_SAMPLES 32
+
+// Each level merges this many buckets of the one below
+#define LOD_FANOUT 4
+
+// 32 to 131072 samples per bucket, the top level is about 2 h per bucket at
+// the 50 ms telemetry period
+#define LOD_LEVELS 7
+
+// Min/max pyramid over every telemetry sample of a session, for drawing
+// long histories. Level l keeps the minimum and maximum of each channel per
+// LOD_BASE_SAMPLES * LOD_FANOUT^l samples. append() updates the open bucket
+// of every level, so the pyramid is always current. A plot draws a level
+// with about one bucket per pixel as a min/max envelope, which looks the same
+// as the raw samples and costs the same at any zoom.
+class TelemetryLod
+{
+public:
+    TelemetryLod() = default;
+
+    void clear();
+
+    // O(LOD_LEVELS), key on the plots' time axis [s]
+    void append(double key, const telemetry_t &t);
+
+    void append(double key, const double *values);
+
+    uint64_t size() const { return count; }
+
+    // Key of the latest sample
+    double last_key() const { return count ? levels[0].back().last_key : 0; }
+
+    static uint64_t bucket_samples(int level);
+
+    // Coarsest level with at most as many samples per bucket as [from, to]
+    // has per pixel, -1 when the raw samples should be drawn
+    int level_for(double from, double to, int pixels) const;
+
+    // Min and max of channel ch in every bucket of level overlapping
+    // [from, to] plus one either side, two points at the middle of the
+    // bucket. Returns the number of points.
+    size_t envelope(int level, double from, double to, int ch, std::vector<double> &keys, std::vector<double> &values) const;
+
+    size_t bytes() const;
+
+private:
+    typedef struct
+    {
+        double first_key;
+        double last_key;
+        float min[TELEM_CHANNELS];
+        float max[TELEM_CHANNELS];
+    } bucket_t;
+
+    std::vector<bucket_t> levels[LOD_LEVELS]; // The last bucket may be open
+    uint64_t count = 0;
+};
+
+#endif // TELEMETRY_LOD_H
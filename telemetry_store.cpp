@@ -0,0 +1,142 @@
+#include "telemetry_store.h"
+
+#include <cmath>
+
+TelemetryStore::TelemetryStore(size_t window)
+{
+    set_window(window);
+}
+
+void TelemetryStore::set_window(size_t window)
+{
+    capacity = window > 0 ? window : 1;
+    columns.assign((TELEM_CHANNELS + 1) * 2 * capacity, 0.0);
+    clear();
+}
+
+void TelemetryStore::clear()
+{
+    head = 0;
+    count = 0;
+    appended = 0;
+
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        minima[ch].pos.clear();
+        minima[ch].begin = 0;
+        maxima[ch].pos.clear();
+        maxima[ch].begin = 0;
+    }
+}
+
+void TelemetryStore::append(double key, const telemetry_t &t)
+{
+    double values[TELEM_CHANNELS];
+
+    for (int i = 0; i < 4; i++)
+    {
+        values[TELEM_CH_D0 + i] = t.d[i];
+        values[TELEM_CH_C0 + i] = t.c[i];
+        values[TELEM_CH_KF_D0 + i] = t.kf_d[i];
+        values[TELEM_CH_KF_V0 + i] = t.kf_v[i];
+    }
+
+    append(key, values);
+}
+
+void TelemetryStore::append(double key, const double *values)
+{
+    const size_t stride = 2 * capacity;
+    const bool full = count == capacity;
+    double *col = columns.data();
+
+    col[head] = key;
+    col[head + capacity] = key;
+
+    for (int ch = 0; ch < TELEM_CHANNELS; ch++)
+    {
+        extreme_queue_t &lo = minima[ch];
+        extreme_queue_t &hi = maxima[ch];
+        const double value = values[ch];
+
+        col += stride;
+
+        // The sample at head leaves the window before it is overwritten
+        if (full)
+        {
+            evict(lo, head);
+            evict(hi, head);
+        }
+
+        // Inf and NaN never count, equal values stay so the older one does
+        if (std::isfinite(value))
+        {
+            while (lo.pos.size() > lo.begin && col[lo.pos.back()] > value)
+            {
+                lo.pos.pop_back();
+            }
+
+            while (hi.pos.size() > hi.begin && col[hi.pos.back()] < value)
+            {
+                hi.pos.pop_back();
+            }
+
+            lo.pos.push_back(uint32_t(head));
+            hi.pos.push_back(uint32_t(head));
+        }
+
+        col[head] = value;
+        col[head + capacity] = value;
+    }
+
+    head = head + 1 == capacity ? 0 : head + 1;
+
+    if (count < capacity)
+    {
+        count++;
+    }
+
+    appended++;
+}
+
+bool TelemetryStore::channel_range(int ch, double &lower, double &upper) const
+{
+    const extreme_queue_t &lo = minima[ch];
+    const extreme_queue_t &hi = maxima[ch];
+
+    if (lo.pos.size() == lo.begin)
+    {
+        return false;
+    }
+
+    const double *col = columns.data() + (ch + 1) * 2 * capacity;
+
+    lower = col[lo.pos[lo.begin]];
+    upper = col[hi.pos[hi.begin]];
+    return true;
+}
+
+void TelemetryStore::evict(extreme_queue_t &q, size_t pos)
+{
+    if (q.pos.size() == q.begin || q.pos[q.begin] != pos)
+    {
+        return;
+    }
+
+    q.begin++;
+
+    // Reuse the memory once the evicted entries outnumber the others
+    if (q.begin > 1024 && q.begin > q.pos.size() - q.begin)
+    {
+        q.pos.erase(q.pos.begin(), q.pos.begin() + std::ptrdiff_t(q.begin));
+        q.begin = 0;
+    }
+}
+
+sample_span_t TelemetryStore::column(int col) const
+{
+    // Oldest sample, the mirror copy makes [start, start + count) contiguous
+    size_t start = (head + capacity - count) % capacity;
+
+    return {columns.data() + col * 2 * capacity + start, count};
+}
@@ -0,0 +1,89 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "telemetry.h"
+
+// Plotted telemetry channels, one column each in TelemetryStore
+enum telemetry_channel
+{
+    TELEM_CH_D0,
+    TELEM_CH_C0 = TELEM_CH_D0 + 4,
+    TELEM_CH_KF_D0 = TELEM_CH_C0 + 4,
+    TELEM_CH_KF_V0 = TELEM_CH_KF_D0 + 4,
+    TELEM_CHANNELS = TELEM_CH_KF_V0 + 4
+};
+
+// Read-only view of contiguous samples
+typedef struct
+{
+    const double *data;
+    size_t size;
+} sample_span_t;
+
+// Sliding window over the last window() telemetry samples, stored as one
+// column per channel plus one for the timestamps (structure of arrays).
+// Every sample is written twice, at i and i + window, so the window is always
+// one contiguous span per column and append never moves old samples.
+// The value range of each channel's window is tracked with a pair of
+// monotonic queues, so autoscaling doesn't scan the window.
+class TelemetryStore
+{
+public:
+    explicit TelemetryStore(size_t window = 250);
+
+    // Drops all samples
+    void set_window(size_t window);
+
+    void clear();
+
+    // O(1), evicts the oldest sample once the window is full
+    void append(double key, const telemetry_t &t);
+
+    void append(double key, const double *values);
+
+    size_t size() const { return count; }
+
+    size_t window() const { return capacity; }
+
+    // Samples appended since construction or clear(), lets consumers tell
+    // which samples are new since they last looked
+    uint64_t total() const { return appended; }
+
+    sample_span_t keys() const { return column(0); }
+
+    sample_span_t channel(int ch) const { return column(ch + 1); }
+
+    // Smallest and largest finite value of a channel's window in O(1), false
+    // if there is none. Same as QCustomPlot's scan of the window: of equal
+    // values (+0.0, -0.0) the older one counts.
+    bool channel_range(int ch, double &lower, double &upper) const;
+
+private:
+    // Window positions of the samples that are still candidates for the
+    // extreme, oldest first. Entries before begin have left the window.
+    typedef struct
+    {
+        std::vector<uint32_t> pos;
+        size_t begin;
+    } extreme_queue_t;
+
+    sample_span_t column(int col) const;
+
+    // Drops the oldest candidate if it is the sample at pos being evicted
+    static void evict(extreme_queue_t &q, size_t pos);
+
+    std::vector<double> columns; // (TELEM_CHANNELS + 1) columns of 2 * capacity
+    size_t capacity = 0;
+    size_t head = 0;             // Next write position in [0, capacity)
+    size_t count = 0;
+    uint64_t appended = 0;
+
+    extreme_queue_t minima[TELEM_CHANNELS]; // Values ascending
+    extreme_queue_t maxima[TELEM_CHANNELS]; // Values descending
+};
+
+#endif // TELEMETRY_STORE_H
@@ -0,0 +1,119 @@
+#include "thread_monitor.h"
+
+const char *fw_thread_name(enum fw_thread thread)
+{
+    switch (thread)
+    {
+    case FW_THREAD_DOCK: return "dock";
+    case FW_THREAD_COIL: return "coil";
+    case FW_THREAD_TELEM: return "telem";
+    case FW_THREAD_TCMD: return "tcmd";
+    case FW_THREAD_RANGE: return "range";
+    case FW_THREADS: break;
+    }
+
+    return "?";
+}
+
+int fw_thread_period(enum fw_thread thread)
+{
+    switch (thread)
+    {
+    case FW_THREAD_DOCK: return THREAD_PERIOD_DOCK_MILLIS;
+    case FW_THREAD_COIL: return THREAD_PERIOD_COIL_MILLIS;
+    case FW_THREAD_TELEM: return THREAD_PERIOD_TELEM_MILLIS;
+    case FW_THREAD_TCMD: return THREAD_PERIOD_TCMD_MILLIS;
+    case FW_THREAD_RANGE: return THREAD_PERIOD_RANGE_MILLIS;
+    case FW_THREADS: break;
+    }
+
+    return 0;
+}
+
+ThreadMonitor::ThreadMonitor(size_t window)
+    : capacity(window > 0 ? window : 1)
+    , ring(capacity * FW_THREADS, unmeasured)
+{
+    for (int i = 0; i < FW_THREADS; i++)
+    {
+        period_us[i] = uint32_t(fw_thread_period(fw_thread(i))) * 1000;
+        limit_us[i] = period_us[i] * THREAD_OVERRUN_PERCENT / 100;
+    }
+}
+
+void ThreadMonitor::reset()
+{
+    head = 0;
+    count = 0;
+    ring.assign(ring.size(), unmeasured);
+
+    for (int i = 0; i < FW_THREADS; i++)
+    {
+        session_hist[i].reset();
+        window_hist[i].reset();
+        session_overruns[i] = 0;
+        window_overruns[i] = 0;
+    }
+}
+
+uint32_t ThreadMonitor::record(const float *dt)
+{
+    uint32_t *slot = &ring[head * FW_THREADS];
+    uint32_t overran = 0;
+
+    for (int i = 0; i < FW_THREADS; i++)
+    {
+        // Evict the oldest frame once the window is full
+        if (count == capacity && slot[i] != unmeasured)
+        {
+            window_hist[i].remove(slot[i]);
+            window_overruns[i] -= slot[i] > limit_us[i];
+        }
+
+        slot[i] = unmeasured;
+
+        if (!(dt[i] > 0))
+        {
+            continue;
+        }
+
+        // Over an hour is as good as forever
+        const uint32_t us = uint32_t((dt[i] < 4.0e6f ? dt[i] : 4.0e6f) * 1000 + 0.5f);
+        const uint32_t late = us > period_us[i] ? us - period_us[i] : 0;
+
+        slot[i] = late;
+        session_hist[i].record(late);
+        window_hist[i].record(late);
+
+        if (late > limit_us[i])
+        {
+            session_overruns[i]++;
+            window_overruns[i]++;
+            overran |= 1u << i;
+        }
+    }
+
+    head = head + 1 == capacity ? 0 : head + 1;
+
+    if (count < capacity)
+    {
+        count++;
+    }
+
+    return overran;
+}
+
+uint32_t ThreadMonitor::alarms() const
+{
+    uint32_t bits = 0;
+
+    for (int i = 0; i < FW_THREADS; i++)
+    {
+        if (window_overruns[i] > 0)
+        {
+            bits |= 1u << i;
+        }
+    }
+
+    return bits;
+}
@@ -0,0 +1,77 @@
+#ifndef THREAD_MONITOR_H
+#define THREAD_MONITOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "latency_histogram.h"
+#include "sat_config.h"
+
+// Firmware threads, in the order of telemetry_t::dt
+enum fw_thread
+{
+    FW_THREAD_DOCK,
+    FW_THREAD_COIL,
+    FW_THREAD_TELEM,
+    FW_THREAD_TCMD,
+    FW_THREAD_RANGE,
+    FW_THREADS
+};
+
+// Frames in the sliding window, 10 s of telemetry
+#define THREAD_MONITOR_WINDOW (10000 / THREAD_PERIOD_TELEM_MILLIS)
+
+// A period this many percent longer than configured is an overrun
+#define THREAD_OVERRUN_PERCENT 10
+
+const char *fw_thread_name(enum fw_thread thread);
+
+// Configured period [ms] from sat_config.h
+int fw_thread_period(enum fw_thread thread);
+
+// Statistics of the thread periods the firmware reports in every frame, over
+// the whole session and over the last window() frames. The histograms hold
+// how late a period ended against sat_config.h [us], early ones count as on
+// time, which keeps them exact to the microsecond for small delays. A thread
+// is in alarm while it overran its deadline within the window. record() is
+// O(1), the window takes back the sample that falls out of it.
+class ThreadMonitor
+{
+public:
+    explicit ThreadMonitor(size_t window = THREAD_MONITOR_WINDOW);
+
+    // Takes telemetry_t::dt of one frame, returns a bit per thread that
+    // overran in it. Threads reporting 0 are not measured.
+    uint32_t record(const float *dt);
+
+    void reset();
+
+    size_t window() const { return capacity; }
+
+    const LatencyHistogram &session(enum fw_thread thread) const { return session_hist[thread]; }
+    const LatencyHistogram &recent(enum fw_thread thread) const { return window_hist[thread]; }
+
+    uint64_t overruns(enum fw_thread thread) const { return session_overruns[thread]; }
+    uint32_t recent_overruns(enum fw_thread thread) const { return window_overruns[thread]; }
+
+    // A bit per thread that overran within the window
+    uint32_t alarms() const;
+
+private:
+    static constexpr uint32_t unmeasured = UINT32_MAX;
+
+    size_t capacity;
+    size_t head = 0;             // Oldest frame once the window is full
+    size_t count = 0;
+    std::vector<uint32_t> ring;  // FW_THREADS delays [us] per frame
+
+    LatencyHistogram session_hist[FW_THREADS];
+    LatencyHistogram window_hist[FW_THREADS];
+    uint64_t session_overruns[FW_THREADS] = {};
+    uint32_t window_overruns[FW_THREADS] = {};
+    uint32_t period_us[FW_THREADS];
+    uint32_t limit_us[FW_THREADS]; // Delay that counts as an overrun
+};
+
+#endif // THREAD_MONITOR_H
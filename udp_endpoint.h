@@ -0,0 +1,98 @@
+#ifndef UDP_ENDPOINT_H
+#define UDP_ENDPOINT_H
+
+#include <QHashFunctions>
+#include <QHostAddress>
+
+#include <cstdint>
+#include <cstring>
+
+// Address and port of a satellite on the link, plain bytes so it can go
+// through the lock-free rings and into recordings. IPv4 addresses are kept
+// IPv4-mapped (::ffff:a.b.c.d), so both protocols compare and hash alike.
+typedef struct
+{
+    uint8_t ip[16]; // Network byte order
+    uint16_t port;
+} udp_endpoint_t;
+
+static_assert(sizeof(udp_endpoint_t) == 18, "udp_endpoint_t must not be padded");
+
+// ip in host byte order, as QHostAddress::toIPv4Address()
+inline udp_endpoint_t udp_endpoint_v4(uint32_t ip, uint16_t port)
+{
+    udp_endpoint_t e = {};
+    e.ip[10] = 0xff;
+    e.ip[11] = 0xff;
+    e.ip[12] = uint8_t(ip >> 24);
+    e.ip[13] = uint8_t(ip >> 16);
+    e.ip[14] = uint8_t(ip >> 8);
+    e.ip[15] = uint8_t(ip);
+    e.port = port;
+
+    return e;
+}
+
+inline udp_endpoint_t udp_endpoint(const QHostAddress &ip, uint16_t port)
+{
+    bool v4 = false;
+    const quint32 ip4 = ip.toIPv4Address(&v4);
+
+    if (v4)
+    {
+        return udp_endpoint_v4(ip4, port);
+    }
+
+    udp_endpoint_t e = {};
+    const Q_IPV6ADDR ip6 = ip.toIPv6Address();
+    memcpy(e.ip, ip6.c, sizeof(e.ip));
+    e.port = port;
+
+    return e;
+}
+
+inline bool udp_endpoint_is_v4(const udp_endpoint_t &e)
+{
+    static const uint8_t mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+    return memcmp(e.ip, mapped, sizeof(mapped)) == 0;
+}
+
+// IPv4 address in host byte order, only meaningful if udp_endpoint_is_v4()
+inline uint32_t udp_endpoint_ipv4(const udp_endpoint_t &e)
+{
+    return uint32_t(e.ip[12]) << 24 | uint32_t(e.ip[13]) << 16 | uint32_t(e.ip[14]) << 8 | e.ip[15];
+}
+
+// IPv4-mapped addresses come back as IPv4 addresses
+inline QHostAddress udp_endpoint_address(const udp_endpoint_t &e)
+{
+    if (udp_endpoint_is_v4(e))
+    {
+        return QHostAddress(udp_endpoint_ipv4(e));
+    }
+
+    return QHostAddress(e.ip);
+}
+
+inline bool udp_endpoint_same_address(const udp_endpoint_t &a, const udp_endpoint_t &b)
+{
+    return memcmp(a.ip, b.ip, sizeof(a.ip)) == 0;
+}
+
+inline bool operator==(const udp_endpoint_t &a, const udp_endpoint_t &b)
+{
+    return udp_endpoint_same_address(a, b) && a.port == b.port;
+}
+
+inline bool operator!=(const udp_endpoint_t &a, const udp_endpoint_t &b)
+{
+    return !(a == b);
+}
+
+inline size_t qHash(const udp_endpoint_t &e, size_t seed = 0)
+{
+    return qHashMulti(seed, qHashBits(e.ip, sizeof(e.ip)), e.port);
+}
+
+#endif // UDP_ENDPOINT_H
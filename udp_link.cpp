@@ -0,0 +1,261 @@
+#include "udp_link.h"
+#include "sat_config.h"
+
+#include <QDebug>
+
+#include <QUdpSocket>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <ctime>
+#endif
+
+UdpLink::UdpLink(size_t ring_capacity, QObject *parent)
+    : QObject(parent)
+    , ring(ring_capacity)
+{
+    clock.start();
+}
+
+size_t UdpLink::drain(telemetry_rx_t *out, size_t max)
+{
+    // Clear before popping so frames pushed meanwhile raise a new signal
+    notify_pending.store(false, std::memory_order_release);
+
+    return ring.pop_batch(out, max);
+}
+
+bool UdpLink::open(quint16 local_port)
+{
+    close();
+
+#ifdef Q_OS_LINUX
+    if (mmsg.open(local_port))
+    {
+        notifier = new QSocketNotifier(mmsg.descriptor(), QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &UdpLink::receive_mmsg);
+
+        qDebug() << "UDP Enabled. Receiving with recvmmsg() on port" << mmsg.local_port();
+        return true;
+    }
+
+    qDebug() << "recvmmsg() socket unavailable, falling back to QUdpSocket:" << qt_error_string(errno);
+#endif
+
+    return open_socket(local_port);
+}
+
+bool UdpLink::open_socket(quint16 local_port)
+{
+    if (!socket)
+    {
+        socket = new QUdpSocket(this);
+
+        connect(socket, &QUdpSocket::readyRead, this, &UdpLink::receive_socket);
+    }
+
+    if (!socket->bind(QHostAddress::Any, local_port))
+    {
+        qDebug() << "Failed to bind UDP socket:" << socket->errorString();
+        return false;
+    }
+
+    qDebug() << "UDP Enabled. Receiving from:" << socket->localAddress().toString() << socket->localPort();
+    return true;
+}
+
+quint16 UdpLink::local_port() const
+{
+#ifdef Q_OS_LINUX
+    if (mmsg.is_open())
+    {
+        return mmsg.local_port();
+    }
+#endif
+
+    return socket ? socket->localPort() : 0;
+}
+
+void UdpLink::close()
+{
+#ifdef Q_OS_LINUX
+    // The notifier has to go before its descriptor
+    delete notifier;
+    notifier = nullptr;
+
+    mmsg.close();
+#endif
+
+    if (socket)
+    {
+        socket->close();
+    }
+}
+
+void UdpLink::send(const QByteArray &data, const QHostAddress &ip, quint16 port)
+{
+    const udp_endpoint_t dst = udp_endpoint(ip, port);
+    qint64 written = -1;
+
+#ifdef Q_OS_LINUX
+    if (mmsg.is_open())
+    {
+        written = mmsg.send(data.constData(), size_t(data.size()), dst);
+    }
+#endif
+
+    // Only bound if the recvmmsg() socket could not be opened
+    if (socket && socket->state() == QAbstractSocket::BoundState)
+    {
+        written = socket->writeDatagram(data, ip, port);
+    }
+
+    if (recorder && written >= 0)
+    {
+        recorder->record(RECORD_TX, recorder_clock_ns(), dst, data.constData(), size_t(data.size()));
+    }
+
+    emit bytesWritten(written, ip, port);
+}
+
+#ifdef Q_OS_LINUX
+
+void UdpLink::receive_mmsg()
+{
+    bool pushed = false;
+    int n;
+
+    // Drain the socket, one system call per batch of datagrams
+    while ((n = mmsg.receive()) > 0)
+    {
+        // Kernel timestamps are on CLOCK_REALTIME, move them onto the link clock
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+
+        const int64_t realtime = int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        const int64_t now = clock.nsecsElapsed();
+        const int64_t realtime_to_link = now - realtime;
+
+        for (int i = 0; i < n; i++)
+        {
+            int64_t stamp = mmsg.timestamp_ns(i);
+            const udp_endpoint_t src = mmsg.src(i);
+            const bool truncated = mmsg.truncated(i);
+
+            // Everything that arrived is recorded, corrupt frames included
+            if (recorder)
+            {
+                recorder->record(RECORD_RX, stamp >= 0 ? stamp : realtime, src, mmsg.data(i), mmsg.size(i),
+                                 truncated ? RECORD_FLAG_TRUNCATED : 0);
+            }
+
+            if (truncated)
+            {
+                corrupt_count.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            int64_t rx_ns = stamp >= 0 ? stamp + realtime_to_link : now;
+
+            pushed |= accept(QByteArrayView(mmsg.data(i), qsizetype(mmsg.size(i))), src, rx_ns);
+        }
+    }
+
+    // E.g. a seccomp sandbox that denies recvmmsg(), QUdpSocket still works there
+    if (n < 0 && (errno == ENOSYS || errno == EPERM))
+    {
+        const quint16 port = mmsg.local_port();
+
+        qDebug() << "recvmmsg() failed, falling back to QUdpSocket:" << qt_error_string(errno);
+
+        // Called from the notifier, it can't be deleted right away
+        notifier->setEnabled(false);
+        notifier->deleteLater();
+        notifier = nullptr;
+        mmsg.close();
+
+        open_socket(port);
+    }
+
+    if (pushed && !notify_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        emit telemetryReady();
+    }
+}
+
+#endif // Q_OS_LINUX
+
+void UdpLink::receive_socket()
+{
+    // Text frames are at most MAX_BUFFER_SIZE_TELEM long, binary frames are shorter
+    char buffer[MAX_BUFFER_SIZE_TELEM];
+    bool pushed = false;
+
+    while (socket->hasPendingDatagrams())
+    {
+        // readDatagram() silently drops what doesn't fit
+        const bool truncated = socket->pendingDatagramSize() > qint64(sizeof(buffer));
+        qint64 size = socket->readDatagram(buffer, sizeof(buffer), &sender, &sender_port);
+
+        if (size < 0)
+        {
+            break;
+        }
+
+        const udp_endpoint_t src = udp_endpoint(sender, sender_port);
+
+        if (recorder)
+        {
+            recorder->record(RECORD_RX, recorder_clock_ns(), src, buffer, size_t(size), truncated ? RECORD_FLAG_TRUNCATED : 0);
+        }
+
+        if (truncated)
+        {
+            corrupt_count.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // No kernel timestamps through QUdpSocket, stamp on reading
+        pushed |= accept(QByteArrayView(buffer, size), src, clock.nsecsElapsed());
+    }
+
+    if (pushed && !notify_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        emit telemetryReady();
+    }
+}
+
+bool UdpLink::accept(QByteArrayView rx, const udp_endpoint_t &src, int64_t rx_ns)
+{
+    telemetry_rx_t frame;
+
+    if (!decode_telemetry(rx, frame.t))
+    {
+        corrupt_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (!check_telemetry_crc(rx, frame.t))
+    {
+        crc_mismatch_count.fetch_add(1, std::memory_order_relaxed);
+
+        if (telemetry_crc_enforced(rx))
+        {
+            corrupt_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    frame.rx_ns = rx_ns;
+    frame.src = src;
+
+    if (!ring.push(frame))
+    {
+        overflow_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef UDP_LINK_H
+#define UDP_LINK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+
+#include <atomic>
+
+#include "flight_recorder.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
+#include "udp_endpoint.h"
+#include "udp_mmsg.h"
+
+class QSocketNotifier;
+class QUdpSocket;
+
+// Decoded telemetry frame as handed from the receiver thread to the GUI
+typedef struct
+{
+    telemetry_t t;
+    int64_t rx_ns;      // Arrival time on the link clock, see UdpLink::now_ns()
+    udp_endpoint_t src; // Address and port of the sending satellite
+} telemetry_rx_t;
+
+// Owns the UDP socket on a dedicated I/O thread. Datagrams are decoded and
+// CRC checked there and pushed into a lock-free ring that the GUI drains.
+// Call the slots through queued connections once moved to its thread.
+// On Linux datagrams are received in batches with recvmmsg(), elsewhere, or
+// if that socket cannot be opened, through QUdpSocket.
+class UdpLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UdpLink(size_t ring_capacity = 1024, QObject *parent = nullptr);
+
+    // Hands every datagram received or sent to the recorder, set before
+    // moving the link to its thread
+    void set_recorder(FlightRecorder *r) { recorder = r; }
+
+    // Consumer side, GUI thread only. Returns the number of frames popped.
+    size_t drain(telemetry_rx_t *out, size_t max);
+
+    size_t ring_size() const { return ring.size(); }
+    size_t ring_capacity() const { return ring.capacity(); }
+    size_t ring_peak() const { return ring.peak_size(); }
+    uint64_t overflow() const { return overflow_count.load(std::memory_order_relaxed); }
+    uint64_t corrupt() const { return corrupt_count.load(std::memory_order_relaxed); }
+
+    // Frames whose CRC did not match, text frames among them are still
+    // delivered, see telemetry_crc_enforced()
+    uint64_t crc_mismatches() const { return crc_mismatch_count.load(std::memory_order_relaxed); }
+
+    // Link clock [ns], monotonic, any thread. Frames are stamped with the
+    // kernel's receive time on it where available (SO_TIMESTAMPNS on Linux),
+    // otherwise with the time they were read from the socket.
+    int64_t now_ns() const { return clock.nsecsElapsed(); }
+
+    // Port the socket is bound to, 0 if closed
+    quint16 local_port() const;
+
+public slots:
+    bool open(quint16 local_port);
+
+    void close();
+
+    void send(const QByteArray &data, const QHostAddress &ip, quint16 port);
+
+signals:
+    // Emitted once when frames become available, not per frame
+    void telemetryReady();
+
+    // Result of each send() to ip and port, -1 if the datagram could not be
+    // written
+    void bytesWritten(qint64 bytes, const QHostAddress &ip, quint16 port);
+
+private slots:
+#ifdef Q_OS_LINUX
+    void receive_mmsg();
+#endif
+
+    void receive_socket();
+
+private:
+    bool open_socket(quint16 local_port);
+
+    // Decodes one datagram into the ring, returns true if it was pushed
+    bool accept(QByteArrayView rx, const udp_endpoint_t &src, int64_t rx_ns);
+
+#ifdef Q_OS_LINUX
+    UdpMmsgSocket mmsg;
+    QSocketNotifier *notifier = nullptr;
+#endif
+    QUdpSocket *socket = nullptr;
+    QHostAddress sender; // Reused, saves an allocation per datagram
+    quint16 sender_port = 0;
+    QElapsedTimer clock;
+    FlightRecorder *recorder = nullptr;
+
+    SpscRing<telemetry_rx_t> ring;
+    std::atomic<bool> notify_pending{false};
+    std::atomic<uint64_t> overflow_count{0};
+    std::atomic<uint64_t> corrupt_count{0};
+    std::atomic<uint64_t> crc_mismatch_count{0};
+};
+
+#endif // UDP_LINK_H
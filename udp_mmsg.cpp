@@ -0,0 +1,218 @@
+#include "udp_mmsg.h"
+
+#ifdef Q_OS_LINUX
+
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+UdpMmsgSocket::UdpMmsgSocket()
+{
+    // The slab is set up once, receive() only resets what the kernel changed
+    for (int i = 0; i < UDP_MMSG_BATCH; i++)
+    {
+        iovs[i].iov_base = slab[i];
+        iovs[i].iov_len = sizeof(slab[i]);
+
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_control = ctrl[i];
+    }
+}
+
+UdpMmsgSocket::~UdpMmsgSocket()
+{
+    close();
+}
+
+bool UdpMmsgSocket::open(uint16_t local_port)
+{
+    close();
+
+    // IPv6 with IPv4-mapped addresses for IPv4 senders, plain IPv4 on kernels
+    // without IPv6
+    family = AF_INET6;
+    fd = ::socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 && errno == EAFNOSUPPORT)
+    {
+        family = AF_INET;
+        fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    int bound;
+
+    if (family == AF_INET6)
+    {
+        int off = 0;
+        ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+        struct sockaddr_in6 addr = {};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons(local_port);
+
+        bound = ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    }
+    else
+    {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(local_port);
+
+        bound = ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    }
+
+    if (bound < 0)
+    {
+        close();
+        return false;
+    }
+
+    // Not fatal, timestamp_ns() then reports no timestamps
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+    return true;
+}
+
+void UdpMmsgSocket::close()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+uint16_t UdpMmsgSocket::local_port() const
+{
+    struct sockaddr_in6 addr = {};
+    socklen_t len = sizeof(addr);
+
+    if (fd < 0 || ::getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &len) < 0)
+    {
+        return 0;
+    }
+
+    // The port is at the same offset in sockaddr_in
+    return ntohs(addr.sin6_port);
+}
+
+int UdpMmsgSocket::receive()
+{
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < UDP_MMSG_BATCH; i++)
+    {
+        msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+    }
+
+    int n;
+    do
+    {
+        n = ::recvmmsg(fd, msgs, UDP_MMSG_BATCH, MSG_DONTWAIT, nullptr);
+        syscall_count++;
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0)
+    {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+
+    datagram_count += n;
+    return n;
+}
+
+udp_endpoint_t UdpMmsgSocket::src(int i) const
+{
+    if (addrs[i].sin6_family == AF_INET)
+    {
+        const struct sockaddr_in *v4 = reinterpret_cast<const struct sockaddr_in *>(&addrs[i]);
+
+        return udp_endpoint_v4(ntohl(v4->sin_addr.s_addr), ntohs(v4->sin_port));
+    }
+
+    udp_endpoint_t e;
+    memcpy(e.ip, &addrs[i].sin6_addr, sizeof(e.ip));
+    e.port = ntohs(addrs[i].sin6_port);
+
+    return e;
+}
+
+int64_t UdpMmsgSocket::timestamp_ns(int i) const
+{
+    const struct msghdr *hdr = &msgs[i].msg_hdr;
+
+    for (const struct cmsghdr *c = CMSG_FIRSTHDR(hdr); c; c = CMSG_NXTHDR(const_cast<struct msghdr *>(hdr), const_cast<struct cmsghdr *>(c)))
+    {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+
+            return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+    }
+
+    return -1;
+}
+
+int64_t UdpMmsgSocket::send(const char *data, size_t size, const udp_endpoint_t &dst)
+{
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_in6 addr6 = {};
+    struct sockaddr_in addr4 = {};
+    struct sockaddr *addr;
+    socklen_t len;
+
+    if (family == AF_INET6)
+    {
+        addr6.sin6_family = AF_INET6;
+        memcpy(&addr6.sin6_addr, dst.ip, sizeof(dst.ip));
+        addr6.sin6_port = htons(dst.port);
+        addr = reinterpret_cast<struct sockaddr *>(&addr6);
+        len = sizeof(addr6);
+    }
+    else if (udp_endpoint_is_v4(dst))
+    {
+        addr4.sin_family = AF_INET;
+        addr4.sin_addr.s_addr = htonl(udp_endpoint_ipv4(dst));
+        addr4.sin_port = htons(dst.port);
+        addr = reinterpret_cast<struct sockaddr *>(&addr4);
+        len = sizeof(addr4);
+    }
+    else
+    {
+        // IPv6 destination on an IPv4 socket
+        errno = EAFNOSUPPORT;
+        return -1;
+    }
+
+    ssize_t written;
+    do
+    {
+        written = ::sendto(fd, data, size, 0, addr, len);
+    } while (written < 0 && errno == EINTR);
+
+    return written;
+}
+
+#endif // Q_OS_LINUX
@@ -0,0 +1,85 @@
+#ifndef UDP_MMSG_H
+#define UDP_MMSG_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ctime>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "sat_config.h"
+#include "udp_endpoint.h"
+
+// Datagrams taken per recvmmsg() call
+#define UDP_MMSG_BATCH 32
+
+// Non-blocking UDP socket that receives up to UDP_MMSG_BATCH datagrams
+// per recvmmsg() call into a preallocated slab, one system call for a whole
+// burst instead of several per datagram as with QUdpSocket. Datagrams carry
+// the kernel's receive timestamp (SO_TIMESTAMPNS). Dual-stack, IPv4 only if
+// the kernel has no IPv6. Linux only.
+class UdpMmsgSocket
+{
+public:
+    UdpMmsgSocket();
+    ~UdpMmsgSocket();
+
+    UdpMmsgSocket(const UdpMmsgSocket &) = delete;
+    UdpMmsgSocket &operator=(const UdpMmsgSocket &) = delete;
+
+    bool open(uint16_t local_port);
+
+    void close();
+
+    bool is_open() const { return fd >= 0; }
+
+    int descriptor() const { return fd; }
+
+    uint16_t local_port() const;
+
+    // Receives the next batch, returns the number of datagrams, 0 if none are
+    // pending and -1 on errors. The batch stays valid until the next call.
+    int receive();
+
+    const char *data(int i) const { return slab[i]; }
+
+    size_t size(int i) const { return msgs[i].msg_len; }
+
+    // Longer than the slot, the tail was cut off
+    bool truncated(int i) const { return msgs[i].msg_hdr.msg_flags & MSG_TRUNC; }
+
+    udp_endpoint_t src(int i) const;
+
+    // Kernel receive timestamp [ns] on CLOCK_REALTIME, -1 if missing
+    int64_t timestamp_ns(int i) const;
+
+    // Returns the bytes written or -1
+    int64_t send(const char *data, size_t size, const udp_endpoint_t &dst);
+
+    uint64_t syscalls() const { return syscall_count; }
+
+    uint64_t datagrams() const { return datagram_count; }
+
+private:
+    int fd = -1;
+    int family = AF_UNSPEC;
+
+    char slab[UDP_MMSG_BATCH][MAX_BUFFER_SIZE_TELEM];
+    struct iovec iovs[UDP_MMSG_BATCH];
+    struct sockaddr_in6 addrs[UDP_MMSG_BATCH]; // sockaddr_in on IPv4 sockets
+    struct mmsghdr msgs[UDP_MMSG_BATCH];
+    alignas(struct cmsghdr) char ctrl[UDP_MMSG_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+
+    uint64_t syscall_count = 0;
+    uint64_t datagram_count = 0;
+};
+
+#endif // Q_OS_LINUX
+
+#endif // UDP_MMSG_H